@@ -3,14 +3,26 @@ CayenneLPP::CayenneLPP(uint8_t size)
 : maxsize(size) {
 	buffer = (uint8_t*)malloc(size);
 	cursor = 0;
+	reserved = 0;
+	ownsBuffer = true;
+}
+
+CayenneLPP::CayenneLPP(uint8_t *buffer, uint8_t size)
+: buffer(buffer), maxsize(size) {
+	cursor = 0;
+	reserved = 0;
+	ownsBuffer = false;
 }
 
 CayenneLPP::~CayenneLPP(void) {
-	free(buffer);
+	if (ownsBuffer) {
+		free(buffer);
+	}
 }
 
 void CayenneLPP::reset(void) {
 	cursor = 0;
+	reserved = 0;
 }
 
 uint8_t CayenneLPP::getSize(void) {
@@ -26,125 +38,276 @@ uint8_t CayenneLPP::copy(uint8_t* dst) {
 	return cursor;
 }
 
+uint8_t CayenneLPP::addRaw(const uint8_t *data, uint8_t size) {
+	uint8_t *dst = reserve(size);
+	if (!dst) {
+		return 0;
+	}
+	memcpy(dst, data, size);
+
+	return commit();
+}
+
 uint8_t CayenneLPP::addBit(uint8_t channel, uint8_t type, uint8_t value) {
-	buffer[cursor++] = channel;
-	buffer[cursor++] = type;
-	buffer[cursor++] = value >> 8;
+	uint8_t *dst = reserve(3);
+	if (!dst) {
+		return 0;
+	}
+	dst[0] = channel;
+	dst[1] = type;
+	dst[2] = value & 0x01;
 
-	return cursor;
+	return commit();
 }
 
 uint8_t CayenneLPP::addCustomByte(uint8_t channel, uint8_t type, float value, uint16_t resolution, uint8_t num_bytes) {
-	buffer[cursor++] = channel;
-	buffer[cursor++] = type;
+	if (num_bytes > 7) {
+		return 0;
+	}
+	uint8_t *dst = reserve(4 + num_bytes);
+	if (!dst) {
+		return 0;
+	}
+	dst[0] = channel;
+	dst[1] = type;
 
 	uint16_t combined_res_num = ((resolution << 3) | num_bytes);
-	buffer[cursor++] = (combined_res_num >> 8) & 0xFF;  // Store the high byte
-	buffer[cursor++] = combined_res_num & 0xFF;         // Store the low byte
+	dst[2] = (combined_res_num >> 8) & 0xFF;  // Store the high byte
+	dst[3] = combined_res_num & 0xFF;         // Store the low byte
 
 	uint32_t valueScaled = value * resolution;
 
-	for (int byteIndex = num_bytes - 1; byteIndex >= 0; --byteIndex) {
-		// Shift the scaled value to the right to isolate the current byte
-		uint8_t byteValue = (valueScaled >> (byteIndex * 8)) & 0xFF;
-		// Store the extracted byte in the buffer
-		buffer[cursor++] = byteValue;
+	for (uint8_t i = 0; i < num_bytes; i++) {
+		uint8_t byteIndex = num_bytes - 1 - i;
+		// Shift the scaled value to the right to isolate the current byte, bytes above the 4th are 0
+		dst[4 + i] = (byteIndex < 4) ? (valueScaled >> (byteIndex * 8)) & 0xFF : 0;
 	}
+
+	return commit();
 }
 
 uint8_t CayenneLPP::addByte(uint8_t channel, uint8_t type, float value, uint8_t resolution) {
-	if ((cursor + 3) > maxsize) {
+	return addByte(channel, type, (int16_t)(int32_t)(value * resolution));
+}
+
+uint8_t CayenneLPP::addByte(uint8_t channel, uint8_t type, int16_t value) {
+	uint8_t *dst = reserve(3);
+	if (!dst) {
 		return 0;
 	}
-	uint8_t valueScaled = value * resolution;
-	buffer[cursor++] = channel;
-	buffer[cursor++] = type;
-	buffer[cursor++] = valueScaled;
+	dst[0] = channel;
+	dst[1] = type;
+	dst[2] = value;
 
-	return cursor;
+	return commit();
 }
 
 uint8_t CayenneLPP::addWord(uint8_t channel, uint8_t type, float value, uint8_t resolution) {
-	if ((cursor + 4) > maxsize) {
+	return addWord(channel, type, (int16_t)(int32_t)(value * resolution));  // via int32_t so signed and unsigned words both fit
+}
+
+uint8_t CayenneLPP::addWord(uint8_t channel, uint8_t type, int16_t value) {
+	uint8_t *dst = reserve(4);
+	if (!dst) {
 		return 0;
 	}
-	uint16_t valueScaled = value * resolution;
-	buffer[cursor++] = channel;
-	buffer[cursor++] = type;
-	buffer[cursor++] = valueScaled >> 8;    // Store most significant byte
-	buffer[cursor++] = valueScaled & 0xFF;  // Store least significant byte
+	dst[0] = channel;
+	dst[1] = type;
+	LppBigEndian<2>::write(dst + 2, value);
 
-	return cursor;
+	return commit();
 }
 
-uint8_t CayenneLPP::addDoubleWord(uint8_t channel, uint8_t type, uint32_t value, uint8_t resolution) {
-	if ((cursor + 6) > maxsize) {
+uint8_t CayenneLPP::addDoubleWord(uint8_t channel, uint8_t type, uint32_t value, uint8_t) {
+	// The value is sent as is, the resolution is only used by the decoder
+	return addDoubleWord(channel, type, (int32_t)value);
+}
+
+uint8_t CayenneLPP::addDoubleWord(uint8_t channel, uint8_t type, int32_t value) {
+	uint8_t *dst = reserve(6);
+	if (!dst) {
 		return 0;
 	}
-	uint32_t valueScaled = value * resolution;
-	buffer[cursor++] = channel;
-	buffer[cursor++] = type;
-	buffer[cursor++] = (value >> 24) & 0xFF;  // Store the most significant byte
-	buffer[cursor++] = (value >> 16) & 0xFF;  // Store the second most significant byte
-	buffer[cursor++] = (value >> 8) & 0xFF;   // Store the third most significant byte
-	buffer[cursor++] = value & 0xFF;          // Store the least significant byte
+	dst[0] = channel;
+	dst[1] = type;
+	LppBigEndian<4>::write(dst + 2, value);
 
-	return cursor;
+	return commit();
 }
 
-uint8_t CayenneLPP::addFloat(uint8_t channel, uint8_t type, float value, uint8_t resolution) {
+uint8_t CayenneLPP::addFloat(uint8_t channel, uint8_t, float value, uint8_t) {
 	int32_t scaledValue = value * 10000000;  // scale by 10^7 for 0.0000001 resolution
 
-	buffer[cursor++] = channel;
-	buffer[cursor++] = LPP_ADDFLOAT;  // Assuming LPP_ADDFLOAT is a defined constant for the data type
-
-	// Add the individual bytes of the signed 32-bit integer to the buffer
-	buffer[cursor++] = scaledValue >> 24;  // Most significant byte
-	buffer[cursor++] = scaledValue >> 16;  // Second most significant byte
-	buffer[cursor++] = scaledValue >> 8;   // Third most significant byte
-	buffer[cursor++] = scaledValue;        // Least significant byte
-	return cursor;
+	return addDoubleWord(channel, LPP_ADDFLOAT, scaledValue);
 }
 
 uint8_t CayenneLPP::add3Float(uint8_t channel, uint8_t type, float x, float y, float z, uint8_t resolution) {
-	if (type == LPP_GPS_SIZE) {
-		if ((cursor + 11) > maxsize) {
+	if (type == LPP_GPS) {
+		uint8_t *dst = reserve(11);
+		if (!dst) {
 			return 0;
 		}
 		int32_t lat = x * 100 * resolution;  //resolution has to be 100
 		int32_t lon = y * 100 * resolution;
 		int32_t alt = z * 1;
 
-		buffer[cursor++] = channel;
-		buffer[cursor++] = LPP_GPS;
-		buffer[cursor++] = lat >> 16;
-		buffer[cursor++] = lat >> 8;
-		buffer[cursor++] = lat;
-		buffer[cursor++] = lon >> 16;
-		buffer[cursor++] = lon >> 8;
-		buffer[cursor++] = lon;
-		buffer[cursor++] = alt >> 16;
-		buffer[cursor++] = alt >> 8;
-		buffer[cursor++] = alt;
-
-		return cursor;
+		dst[0] = channel;
+		dst[1] = LPP_GPS;
+		LppBigEndian<3>::write(dst + 2, lat);
+		LppBigEndian<3>::write(dst + 5, lon);
+		LppBigEndian<3>::write(dst + 8, alt);
+
+		return commit();
 	} else {
-		if ((cursor + 8) > maxsize) {
-			return 0;
-		}
 		int16_t vx = x * resolution;  //addAccelerometer has to be 1000,
 		int16_t vy = y * resolution;  //addGyrometer has to be 100
 		int16_t vz = z * resolution;
 
-		buffer[cursor++] = channel;
-		buffer[cursor++] = type;
-		buffer[cursor++] = vx >> 8;
-		buffer[cursor++] = vx;
-		buffer[cursor++] = vy >> 8;
-		buffer[cursor++] = vy;
-		buffer[cursor++] = vz >> 8;
-		buffer[cursor++] = vz;
+		return add3Word(channel, type, vx, vy, vz);
+	}
+}
+
+uint8_t CayenneLPP::add3Word(uint8_t channel, uint8_t type, int16_t x, int16_t y, int16_t z) {
+	uint8_t *dst = reserve(8);
+	if (!dst) {
+		return 0;
+	}
+	dst[0] = channel;
+	dst[1] = type;
+	LppBigEndian<2>::write(dst + 2, x);
+	LppBigEndian<2>::write(dst + 4, y);
+	LppBigEndian<2>::write(dst + 6, z);
+
+	return commit();
+}
+
+uint8_t CayenneLPP::addTimeSeries(uint8_t channel, uint8_t type, uint8_t width, uint32_t time, uint16_t interval,
+                                  const int16_t *samples, uint8_t count) {
+	if (width < 1 || width > 2 || (LPP_TIMESERIES_SIZE + count * width) > getAvailable()) {
+		return 0;  // Also when the size does not fit in the uint8_t of reserve()
+	}
+	uint8_t *dst = reserve(LPP_TIMESERIES_SIZE + count * width);
+	if (!dst) {
+		return 0;
+	}
+	dst[0] = channel;
+	dst[1] = LPP_TIMESERIES;
+	dst[2] = type;
+	dst[3] = count;
+	LppBigEndian<4>::write(dst + 4, time);
+	LppBigEndian<2>::write(dst + 8, interval);
+	dst += LPP_TIMESERIES_SIZE;
+
+	for (uint8_t i = 0; i < count; i++) {
+		if (width == 2) {
+			*dst++ = samples[i] >> 8;
+		}
+		*dst++ = samples[i];
+	}
+
+	return commit();
+}
+
+LppBitWriter::LppBitWriter(uint8_t *buffer, uint8_t size)
+: buffer(buffer), maxsize(size), bitpos(0) {
+}
+
+void LppBitWriter::reset(void) {
+	bitpos = 0;
+}
+
+uint8_t LppBitWriter::getSize(void) {
+	return (bitpos + 7) >> 3;
+}
 
-		return cursor;
+uint16_t LppBitWriter::getBitCount(void) {
+	return bitpos;
+}
+
+uint8_t LppBitWriter::write(uint32_t value, uint8_t bits) {
+	if (bits > 32 || (bitpos + bits) > ((uint16_t)maxsize << 3)) {
+		return 0;
 	}
-}
\ No newline at end of file
+
+	// Fast path: whole bytes starting on a byte boundary
+	if (((bitpos | bits) & 0x07) == 0) {
+		uint8_t *dst = buffer + (bitpos >> 3);
+		for (uint8_t n = bits >> 3; n > 0; --n) {
+			*dst++ = value >> ((n - 1) * 8);
+		}
+		bitpos += bits;
+		return getSize();
+	}
+
+	while (bits > 0) {
+		uint8_t offset = bitpos & 0x07;
+		uint8_t room = 8 - offset;                   // Free bits in the current byte
+		uint8_t take = (bits < room) ? bits : room;  // Bits that go into the current byte
+		uint8_t chunk = (value >> (bits - take)) & ((1 << take) - 1);
+		uint8_t *dst = buffer + (bitpos >> 3);
+
+		if (offset == 0) {
+			*dst = 0;  // Start of a fresh byte
+		}
+		*dst |= chunk << (room - take);
+
+		bitpos += take;
+		bits -= take;
+	}
+
+	return getSize();
+}
+
+uint8_t LppBitWriter::writeSigned(int32_t value, uint8_t bits) {
+	return write((uint32_t)value, bits);
+}
+
+LppBitReader::LppBitReader(const uint8_t *buffer, uint8_t size)
+: buffer(buffer), maxsize(size), bitpos(0) {
+}
+
+uint16_t LppBitReader::getRemaining(void) {
+	return ((uint16_t)maxsize << 3) - bitpos;
+}
+
+uint32_t LppBitReader::read(uint8_t bits) {
+	if (bits > 32 || bits > getRemaining()) {
+		return 0;
+	}
+
+	uint32_t value = 0;
+
+	// Fast path: whole bytes starting on a byte boundary
+	if (((bitpos | bits) & 0x07) == 0) {
+		const uint8_t *src = buffer + (bitpos >> 3);
+		for (uint8_t n = bits >> 3; n > 0; --n) {
+			value = (value << 8) | *src++;
+		}
+		bitpos += bits;
+		return value;
+	}
+
+	while (bits > 0) {
+		uint8_t offset = bitpos & 0x07;
+		uint8_t room = 8 - offset;                   // Unread bits in the current byte
+		uint8_t take = (bits < room) ? bits : room;  // Bits that come from the current byte
+		uint8_t chunk = (buffer[bitpos >> 3] >> (room - take)) & ((1 << take) - 1);
+
+		value = (value << take) | chunk;
+
+		bitpos += take;
+		bits -= take;
+	}
+
+	return value;
+}
+
+int32_t LppBitReader::readSigned(uint8_t bits) {
+	uint32_t value = read(bits);
+
+	// Sign-extend when the top bit of the field is set
+	if (bits > 0 && bits < 32 && (value & ((uint32_t)1 << (bits - 1)))) {
+		value |= ~(uint32_t)0 << bits;
+	}
+	return (int32_t)value;
+}
@@ -28,38 +28,286 @@
 
 #include <Arduino.h>
 
-#define LPP_DIGITAL_INPUT 0          /// \ Identifier for digital input data type (1 Byte)
-#define LPP_DIGITAL_OUTPUT 1         /// \ Identifier for digital output data type (1 Byte)
-#define LPP_ANALOG_INPUT 2           /// \ Identifier for analog input data type (2 bytes and is scaled by a factor of 0.01 (signed)
-#define LPP_ANALOG_OUTPUT 3          /// \ Identifier for analog output data type (2 bytes and is scaled by a factor of 0.01 (signed))
-#define LPP_ADDBIT 4                 /// \ Identifier for additional bit data type (1 Byte)
-#define LPP_ADDBYTE 5                /// \ Identifier for additional byte data type (1 Byte)
-#define LPP_ADDWORD 6                /// \ Identifier for additional 2-byte data type (2 bytes)
-#define LPP_ADDDOUBLEWORD 7          /// \ Identifier for additional 4-byte data type (4 bytes)
-#define LPP_ADDFLOAT 8               /// \ Identifier for additional floating-point data type
-#define LPP_CUSTOMBYTE 9             /// \ Identifier for custom data type
-#define LPP_LUMINOSITY 101           /// \ Identifier for luminosity data type (2 bytes, 1 lux unsigned)
-#define LPP_PRESENCE 102             /// \ Identifier for presence data type (1 byte, 1)
-#define LPP_TEMPERATURE 103          /// \ Identifier for temperature data type (2 bytes, 0.1°C signed)
-#define LPP_RELATIVE_HUMIDITY 104    /// \ Identifier for relative humidity data type (1 byte, 0.5% unsigned)
-#define LPP_ACCELEROMETER 113        /// \ Identifier for accelerometer data type (2 bytes per axis, 0.001G)
-#define LPP_BAROMETRIC_PRESSURE 115  /// \ Identifier for barometric pressure data type (2 bytes 0.1 hPa Unsigned)
-#define LPP_GYROMETER 134            /// \ Identifier for gyrometer data type (2 bytes per axis, 0.01 °/s)
-#define LPP_GPS 136                  /// \ Identifier for GPS data type (3 byte lon/lat 0.0001 °, 3 bytes alt 0.01 meter)
-
-// The total number of bytes required for the Data ID, Data Type, and Data Size
-#define LPP_DIGITAL_INPUT_SIZE 3
-#define LPP_DIGITAL_OUTPUT_SIZE 3
-#define LPP_ANALOG_INPUT_SIZE 4
-#define LPP_ANALOG_OUTPUT_SIZE 3
-#define LPP_LUMINOSITY_SIZE 4
-#define LPP_PRESENCE_SIZE 3
-#define LPP_TEMPERATURE_SIZE 4
-#define LPP_RELATIVE_HUMIDITY_SIZE 3
-#define LPP_ACCELEROMETER_SIZE 8
-#define LPP_BAROMETRIC_PRESSURE_SIZE 4
-#define LPP_GYROMETER_SIZE 8
-#define LPP_GPS_SIZE 11
+#include "LppTypes.h"           // Type identifiers and sizes, generated from host/schema/lpp_schema.json
+
+#ifndef LPP_PAYLOAD_MAX_SIZE
+#define LPP_PAYLOAD_MAX_SIZE 51      /// \ Maximum payload size of a LoRaWAN packet
+#endif
+
+/**
+ * @brief Compile-time description of a single LPP field.
+ * @tparam Channel Channel number.
+ * @tparam Type Data type identifier.
+ * @tparam Resolution Factor the value is multiplied with before it is stored.
+ * @tparam Width Number of bytes used for every value.
+ * @tparam Axes Number of values in the field (3 for accelerometer and gyrometer).
+ */
+template <uint8_t Channel, uint8_t Type, uint16_t Resolution, uint8_t Width, uint8_t Axes = 1>
+struct LppField {
+	static const uint8_t channel = Channel;
+	static const uint8_t type = Type;
+	static const uint16_t resolution = Resolution;
+	static const uint8_t width = Width;
+	static const uint8_t axes = Axes;
+	static const uint16_t size = 2 + Width * Axes;
+	static const uint16_t packedSize = Width * Axes;
+};
+
+/**
+ * @brief LppField with the resolution, width and number of values of its type, see LppType in LppTypes.h.
+ * @tparam Channel Channel number.
+ * @tparam Type Data type identifier.
+ */
+template <uint8_t Channel, uint8_t Type>
+struct LppTypeField : LppField<Channel, Type, LppType<Type>::resolution, LppType<Type>::width, LppType<Type>::values> {
+};
+
+/**
+ * @brief Multiply a fixed-point value by 10^exponent using integer math only.
+ * Negative exponents divide and round half away from zero. Used to bring integer sensor readings,
+ * such as 0.01 °C or mV, to the resolution of an LPP type without soft-float on AVR.
+ * @param value Value to be scaled.
+ * @param exponent Power of ten to scale with (-9 to 9).
+ * @return The scaled value.
+ */
+static inline int32_t lppScale(int32_t value, int8_t exponent) {
+	int32_t factor = 1;
+
+	for (int8_t i = (exponent < 0) ? -exponent : exponent; i > 0; i--) {
+		factor *= 10;
+	}
+	if (exponent >= 0) {
+		return value * factor;
+	}
+	return (value + ((value < 0) ? -factor : factor) / 2) / factor;
+}
+
+/**
+ * @brief Value that is already in the units sent on air, the resolution of the field is not applied.
+ * Pass it to LppSchema instead of a float to keep the encoder free of floating point.
+ */
+struct LppScaled {
+	int32_t value;  ///< Scaled value
+};
+
+/**
+ * @brief Make an LppScaled from a fixed-point integer.
+ * @param value Integer reading.
+ * @param exponent Power of ten that brings value to the units sent on air, see lppScale().
+ * @return The scaled value.
+ */
+static inline LppScaled lppScaled(int32_t value, int8_t exponent = 0) {
+	LppScaled scaled = {lppScale(value, exponent)};
+	return scaled;
+}
+
+/**
+ * @brief Apply the resolution of a field to a value.
+ * Floats are multiplied in floating point, integers in integer math and LppScaled values are passed on.
+ * @tparam Resolution Resolution of the field.
+ */
+template <uint16_t Resolution>
+struct LppResolution {
+	static inline int32_t apply(LppScaled value) {
+		return value.value;
+	}
+
+	template <typename Value>
+	static inline int32_t apply(Value value) {
+		// int32_t keeps negative integers signed where int is 16 bits, floats stay floating point
+		return value * (int32_t)Resolution;
+	}
+};
+
+/**
+ * @brief Store the lower Width bytes of a value, most significant byte first.
+ * Unrolled at compile time, so no loop is left in the generated code.
+ */
+template <uint8_t Width>
+struct LppBigEndian {
+	static inline void write(uint8_t *dst, int32_t value) {
+		dst[0] = value >> ((Width - 1) * 8);
+		LppBigEndian<Width - 1>::write(dst + 1, value);
+	}
+};
+
+template <>
+struct LppBigEndian<0> {
+	static inline void write(uint8_t *, int32_t) {}
+};
+
+/**
+ * @brief Write the values of one field and continue with the next field.
+ * @tparam Field The LppField being written.
+ * @tparam Axes Number of values of the field that still have to be written.
+ */
+template <typename Field, uint8_t Axes>
+struct LppAxesWriter {
+	template <typename Next, typename Value, typename... Values>
+	static inline void write(uint8_t *dst, Value value, Values... values) {
+		LppBigEndian<Field::width>::write(dst, LppResolution<Field::resolution>::apply(value));
+		LppAxesWriter<Field, Axes - 1>::template write<Next>(dst + Field::width, values...);
+	}
+};
+
+template <typename Field>
+struct LppAxesWriter<Field, 0> {
+	template <typename Next, typename... Values>
+	static inline void write(uint8_t *dst, Values... values) {
+		Next::write(dst, values...);
+	}
+};
+
+/**
+ * @brief Straight-line writer for a list of fields.
+ * @tparam Headers Write the channel and type bytes in front of every field.
+ */
+template <bool Headers, typename... Fields>
+struct LppFieldWriter;
+
+template <bool Headers>
+struct LppFieldWriter<Headers> {
+	static inline void write(uint8_t *) {}
+};
+
+template <typename Field, typename... Fields>
+struct LppFieldWriter<true, Field, Fields...> {
+	template <typename... Values>
+	static inline void write(uint8_t *dst, Values... values) {
+		dst[0] = Field::channel;
+		dst[1] = Field::type;
+		LppAxesWriter<Field, Field::axes>::template write<LppFieldWriter<true, Fields...> >(dst + 2, values...);
+	}
+};
+
+template <typename Field, typename... Fields>
+struct LppFieldWriter<false, Field, Fields...> {
+	template <typename... Values>
+	static inline void write(uint8_t *dst, Values... values) {
+		LppAxesWriter<Field, Field::axes>::template write<LppFieldWriter<false, Fields...> >(dst, values...);
+	}
+};
+
+/**
+ * @brief Scale the values of one field and continue with the next field.
+ * @tparam Field The LppField being scaled.
+ * @tparam Axes Number of values of the field that still have to be scaled.
+ */
+template <typename Field, uint8_t Axes>
+struct LppAxesScaler {
+	template <typename Next, typename Value, typename... Values>
+	static inline void scale(int32_t *dst, Value value, Values... values) {
+		dst[0] = LppResolution<Field::resolution>::apply(value);
+		LppAxesScaler<Field, Axes - 1>::template scale<Next>(dst + 1, values...);
+	}
+};
+
+template <typename Field>
+struct LppAxesScaler<Field, 0> {
+	template <typename Next, typename... Values>
+	static inline void scale(int32_t *dst, Values... values) {
+		Next::scale(dst, values...);
+	}
+};
+
+/**
+ * @brief Straight-line scaler for a list of fields.
+ */
+template <typename... Fields>
+struct LppFieldScaler;
+
+template <>
+struct LppFieldScaler<> {
+	static inline void scale(int32_t *) {}
+};
+
+template <typename Field, typename... Fields>
+struct LppFieldScaler<Field, Fields...> {
+	template <typename... Values>
+	static inline void scale(int32_t *dst, Values... values) {
+		LppAxesScaler<Field, Field::axes>::template scale<LppFieldScaler<Fields...> >(dst, values...);
+	}
+};
+
+/**
+ * @brief Sum the frame size and the number of values of a list of fields.
+ */
+template <typename... Fields>
+struct LppFieldSum {
+	static const uint16_t size = 0;
+	static const uint16_t packedSize = 0;
+	static const uint8_t count = 0;
+};
+
+template <typename Field, typename... Fields>
+struct LppFieldSum<Field, Fields...> {
+	static const uint16_t size = Field::size + LppFieldSum<Fields...>::size;
+	static const uint16_t packedSize = Field::packedSize + LppFieldSum<Fields...>::packedSize;
+	static const uint8_t count = Field::axes + LppFieldSum<Fields...>::count;
+};
+
+/**
+ * @brief Compile-time LPP frame layout.
+ * The schema is the single source of truth for a frame: the size is known at compile time and the
+ * encoder writes every field at a fixed offset without per-field branches or bounds checks.
+ * @tparam Fields List of LppField types in the order they appear in the frame.
+ */
+template <typename... Fields>
+struct LppSchema {
+	static const uint16_t size = LppFieldSum<Fields...>::size;              ///< Frame size in bytes
+	static const uint16_t packedSize = LppFieldSum<Fields...>::packedSize;  ///< Packed frame size in bytes
+	static const uint8_t count = LppFieldSum<Fields...>::count;             ///< Number of values to pass to encode()
+	static const uint8_t fields = sizeof...(Fields);                        ///< Number of fields
+	static const uint8_t axes[sizeof...(Fields)];                           ///< Number of values of every field
+
+	static_assert(size <= LPP_PAYLOAD_MAX_SIZE, "LPP schema does not fit in LPP_PAYLOAD_MAX_SIZE");
+
+	/**
+	 * @brief Encode a frame into dst, which must hold at least size bytes.
+	 * @param values One value per axis of every field, in schema order.
+	 */
+	template <typename... Values>
+	static inline void encode(uint8_t *dst, Values... values) {
+		static_assert(sizeof...(Values) == count, "Number of values does not match the LPP schema");
+		LppFieldWriter<true, Fields...>::write(dst, values...);
+	}
+
+	/**
+	 * @brief Encode a packed frame into dst, which must hold at least packedSize bytes.
+	 * A packed frame only contains the values. The receiver selects the schema by the LoRaWAN port
+	 * the frame was sent on, so the channel and type bytes are left out.
+	 * @param values One value per axis of every field, in schema order.
+	 */
+	template <typename... Values>
+	static inline void encodePacked(uint8_t *dst, Values... values) {
+		static_assert(sizeof...(Values) == count, "Number of values does not match the LPP schema");
+		LppFieldWriter<false, Fields...>::write(dst, values...);
+	}
+
+	/**
+	 * @brief Scale the values to the integers that are sent on air, without writing a frame.
+	 * Used by encoders that work on the scaled values, such as LppDeltaEncoder.
+	 * @param dst Array of at least count values.
+	 * @param values One value per axis of every field, in schema order.
+	 */
+	template <typename... Values>
+	static inline void scale(int32_t *dst, Values... values) {
+		static_assert(sizeof...(Values) == count, "Number of values does not match the LPP schema");
+		LppFieldScaler<Fields...>::scale(dst, values...);
+	}
+};
+
+template <typename... Fields>
+const uint8_t LppSchema<Fields...>::axes[sizeof...(Fields)] = {Fields::axes...};
+
+/**
+ * @brief Read-only view of an encoded packet, passed by value.
+ * Usage: ttn.sendBytes(span.data, span.size, port).
+ */
+struct LppSpan {
+	const uint8_t *data;  ///< First byte of the packet
+	uint8_t size;         ///< Number of bytes in the packet
+};
 
 /**
  * @brief Cayenne Low Power Protocol (LPP) packet builder class.
@@ -68,16 +316,27 @@
 class CayenneLPP {
 public:
 	/**
-	 * @brief Constructor for CayenneLPP class.
+	 * @brief Constructor for CayenneLPP class, the buffer is allocated on the heap.
+	 * Prefer StaticCayenneLPP or the buffer constructor on devices with little RAM.
 	 * @param size Maximum size of the LPP packet.
 	 */
 	CayenneLPP(uint8_t size);
 
+	/**
+	 * @brief Constructor for CayenneLPP class using a buffer of the caller, nothing is allocated.
+	 * @param buffer Buffer the packet is written into, it must outlive the CayenneLPP object.
+	 * @param size Size of the buffer, the maximum size of the LPP packet.
+	 */
+	CayenneLPP(uint8_t *buffer, uint8_t size);
+
 	/**
 	 * @brief Destructor for CayenneLPP class.
 	 */
 	~CayenneLPP();
 
+	CayenneLPP(const CayenneLPP &) = delete;
+	CayenneLPP &operator=(const CayenneLPP &) = delete;
+
 	/**
 	 * @brief Reset the LPP packet buffer.
 	 */
@@ -95,6 +354,15 @@ public:
 	 */
 	uint8_t *getBuffer(void);
 
+	/**
+	 * @brief Get a view of the LPP packet.
+	 * @return Buffer and size of the LPP packet.
+	 */
+	LppSpan getSpan(void) const {
+		LppSpan span = {buffer, cursor};
+		return span;
+	}
+
 	/**
 	 * @brief Copy the LPP packet buffer to an external buffer.
 	 * @param buffer External buffer to copy the LPP packet buffer into.
@@ -102,11 +370,66 @@ public:
 	 */
 	uint8_t copy(uint8_t *buffer);
 
+	/**
+	 * @brief Get the number of bytes that can still be added.
+	 * @return Free space in the LPP packet buffer.
+	 */
+	uint8_t getAvailable(void) const {
+		return maxsize - cursor;
+	}
+
+	/**
+	 * @brief Reserve room for size bytes at the end of the packet, this is the only bounds check of a field.
+	 * Write at most size bytes to the returned pointer and call commit() to add them to the packet.
+	 * Several fields can be reserved at once, so they share a single check.
+	 * @param size Number of bytes to reserve.
+	 * @return Pointer to the reserved bytes, or NULL when they do not fit.
+	 */
+	uint8_t *reserve(uint8_t size) {
+		if (size > (uint8_t)(maxsize - cursor)) {
+			reserved = 0;
+			return NULL;
+		}
+		reserved = size;
+		return buffer + cursor;
+	}
+
+	/**
+	 * @brief Add the bytes of the last reserve() to the packet.
+	 * @return Size of the LPP packet.
+	 */
+	uint8_t commit(void) {
+		cursor += reserved;
+		reserved = 0;
+		return cursor;
+	}
+
+	/**
+	 * @brief Add the first size bytes of the last reserve() to the packet, when less was written.
+	 * @param size Number of bytes written, at most the reserved size.
+	 * @return Size of the LPP packet.
+	 */
+	uint8_t commit(uint8_t size) {
+		if (size < reserved) {
+			reserved = size;
+		}
+		return commit();
+	}
+
+	/**
+	 * @brief Append bytes that were encoded elsewhere, such as a LppDeltaEncoder frame.
+	 * @param data Bytes to be added to the LPP packet.
+	 * @param size Number of bytes.
+	 * @return Size of the LPP packet, or 0 when the bytes do not fit.
+	 */
+	uint8_t addRaw(const uint8_t *data, uint8_t size);
+
 	/**
 	 * @brief Add a single bit value to the LPP packet.
+	 * The bit still takes a full byte, use LppBitWriter to pack several flags into one byte.
 	 * @param channel Channel number.
 	 * @param type Data type identifier determining how the value will be interpreted.
-	 * @param value Bit value to be added to the LPP packet.
+	 * @param value Bit value to be added to the LPP packet, only bit 0 is used.
 	 */
 	uint8_t addBit(uint8_t channel, uint8_t type, uint8_t value);
 
@@ -131,6 +454,15 @@ public:
 	 */
 	uint8_t addByte(uint8_t channel, uint8_t type, float value, uint8_t resolution);
 
+	/**
+	 * @brief Add a byte value that is already scaled to the resolution of the type, without floating point.
+	 * @param channel Channel number.
+	 * @param type Data type identifier.
+	 * @param value Scaled value, see lppScale().
+	 * @return Size of the LPP packet, or 0 when the value does not fit.
+	 */
+	uint8_t addByte(uint8_t channel, uint8_t type, int16_t value);
+
 	/**
 	 * @brief Add a two-byte value to the LPP packet.
 	 * @param channel Channel number.
@@ -141,22 +473,41 @@ public:
 	 */
 	uint8_t addWord(uint8_t channel, uint8_t type, float value, uint8_t resolution);
 
+	/**
+	 * @brief Add a two-byte value that is already scaled to the resolution of the type, without floating point.
+	 * @param channel Channel number.
+	 * @param type Data type identifier.
+	 * @param value Scaled value, see lppScale().
+	 * @return Size of the LPP packet, or 0 when the value does not fit.
+	 */
+	uint8_t addWord(uint8_t channel, uint8_t type, int16_t value);
+
 	/**
 	 * @brief Add a four-byte value to the LPP packet.
 	 * @param channel Channel number.
 	 * @param type Type
 	 * @param value Four-byte value to be added to the LPP packet.
-	 * @param resolution Resolution of the value, used for interpretation (e.g., scaling).
+	 * @param resolution Ignored, the value is sent as is and the decoder applies the resolution of the type.
 	 * @return Status code indicating the success of the operation.
 	 */
 	uint8_t addDoubleWord(uint8_t channel, uint8_t type, uint32_t value, uint8_t resolution);
 
+	/**
+	 * @brief Add a four-byte value that is already scaled to the resolution of the type, without floating point.
+	 * Also used for LPP_ADDFLOAT, with the value scaled to 0.0000001 units.
+	 * @param channel Channel number.
+	 * @param type Data type identifier.
+	 * @param value Scaled value, see lppScale().
+	 * @return Size of the LPP packet, or 0 when the value does not fit.
+	 */
+	uint8_t addDoubleWord(uint8_t channel, uint8_t type, int32_t value);
+
 	/**
 	 * @brief Add a floating-point value to the LPP packet.
 	 * @param channel Channel number.
-	 * @param type Type
+	 * @param type Ignored, the value is always sent as LPP_ADDFLOAT.
 	 * @param value Floating-point value to be added to the LPP packet.
-	 * @param resolution Resolution of the value, used for interpretation (e.g., scaling).
+	 * @param resolution Ignored, the value is always sent in 0.0000001 units.
 	 * @return Status code indicating the success of the operation.
 	 */
 	uint8_t addFloat(uint8_t channel, uint8_t type, float value, uint8_t resolution);
@@ -171,6 +522,69 @@ public:
 	 */
 	uint8_t add3Float(uint8_t channel, uint8_t type, float x, float y, float z, uint8_t resolution);
 
+	/**
+	 * @brief Add a three axis value that is already scaled to the resolution of the type, without floating point.
+	 * @param channel Channel number.
+	 * @param type Data type identifier (LPP_ACCELEROMETER or LPP_GYROMETER).
+	 * @param x Scaled x value, for the accelerometer in mG.
+	 * @param y Scaled y value.
+	 * @param z Scaled z value.
+	 * @return Size of the LPP packet, or 0 when the value does not fit.
+	 */
+	uint8_t add3Word(uint8_t channel, uint8_t type, int16_t x, int16_t y, int16_t z);
+
+	/**
+	 * @brief Add a series of samples of one sensor with a single channel and type header.
+	 * Layout: channel, LPP_TIMESERIES, sample type, number of samples, time of the first sample (4 bytes),
+	 * interval (2 bytes) and the samples, oldest first.
+	 * @param channel Channel number.
+	 * @param type Data type identifier of the samples.
+	 * @param width Number of bytes per sample (1 or 2), must match the size of the type.
+	 * @param time Time of the first sample in seconds.
+	 * @param interval Time between two samples in seconds.
+	 * @param samples Scaled samples, oldest first.
+	 * @param count Number of samples.
+	 * @return Size of the LPP packet, or 0 when the series does not fit.
+	 */
+	uint8_t addTimeSeries(uint8_t channel, uint8_t type, uint8_t width, uint32_t time, uint16_t interval,
+	                      const int16_t *samples, uint8_t count);
+
+	/**
+	 * @brief Add all fields of a compile-time schema to the LPP packet.
+	 * Only one bounds check is done for the complete schema.
+	 * @tparam Schema LppSchema describing the fields.
+	 * @param values One value per axis of every field, in schema order.
+	 * @return Size of the LPP packet, or 0 when the schema does not fit.
+	 */
+	template <typename Schema, typename... Values>
+	uint8_t addSchema(Values... values) {
+		uint8_t *dst = reserve(Schema::size);
+		if (!dst) {
+			return 0;
+		}
+		Schema::encode(dst, values...);
+
+		return commit();
+	}
+
+	/**
+	 * @brief Add all fields of a compile-time schema to the LPP packet without channel and type bytes.
+	 * The packet must be sent on the LoRaWAN port that identifies the schema to the decoder.
+	 * @tparam Schema LppSchema describing the fields.
+	 * @param values One value per axis of every field, in schema order.
+	 * @return Size of the LPP packet, or 0 when the schema does not fit.
+	 */
+	template <typename Schema, typename... Values>
+	uint8_t addSchemaPacked(Values... values) {
+		uint8_t *dst = reserve(Schema::packedSize);
+		if (!dst) {
+			return 0;
+		}
+		Schema::encodePacked(dst, values...);
+
+		return commit();
+	}
+
 private:
 
 	/**
@@ -190,6 +604,215 @@ private:
 	 * This variable represents the current position within the LPP packet buffer.
 	 */
 	uint8_t cursor;
+
+	/**
+	 * @brief Number of bytes reserved after the cursor by reserve().
+	 */
+	uint8_t reserved;
+
+	/**
+	 * @brief The buffer was allocated by the constructor and is freed by the destructor.
+	 */
+	bool ownsBuffer;
+};
+
+/**
+ * @brief CayenneLPP with inline storage, usable as a global or on the stack without heap use.
+ * @tparam N Maximum size of the LPP packet.
+ */
+template <uint8_t N>
+class StaticCayenneLPP : public CayenneLPP {
+public:
+	/**
+	 * @brief Constructor for StaticCayenneLPP class.
+	 */
+	StaticCayenneLPP() : CayenneLPP(storage, N) {}
+
+private:
+	uint8_t storage[N];  ///< Packet buffer, only its address is used before it is constructed
+};
+
+/**
+ * @brief Fixed-size ring buffer collecting samples between two uplinks.
+ * When the ring is full the oldest sample is overwritten.
+ * @tparam N Maximum number of samples.
+ */
+template <uint8_t N>
+class LppSampleRing {
+public:
+	/**
+	 * @brief Constructor for LppSampleRing class.
+	 * @param interval Time between two samples in seconds.
+	 */
+	LppSampleRing(uint16_t interval)
+	: interval(interval), head(0), count(0), time(0) {
+	}
+
+	/**
+	 * @brief Remove all samples, for example after they have been sent.
+	 */
+	void reset(void) {
+		head = 0;
+		count = 0;
+	}
+
+	/**
+	 * @brief Add a sample.
+	 * @param sample Scaled sample value.
+	 * @param sampleTime Time of the sample in seconds.
+	 */
+	void push(int16_t sample, uint32_t sampleTime) {
+		samples[head] = sample;
+		head = (head + 1) % N;
+		if (count < N) {
+			count++;
+		}
+		time = sampleTime;
+	}
+
+	/**
+	 * @brief Get the number of samples.
+	 * @return Number of samples.
+	 */
+	uint8_t getCount(void) {
+		return count;
+	}
+
+	/**
+	 * @brief Get the time between two samples.
+	 * @return Interval in seconds.
+	 */
+	uint16_t getInterval(void) {
+		return interval;
+	}
+
+	/**
+	 * @brief Get the time of the oldest sample.
+	 * @return Time in seconds.
+	 */
+	uint32_t getBaseTime(void) {
+		return count ? time - (uint32_t)(count - 1) * interval : time;
+	}
+
+	/**
+	 * @brief Rotate the samples in place so the oldest sample is first.
+	 * @return Pointer to getCount() samples, oldest first.
+	 */
+	const int16_t *linearize(void) {
+		if (count == N && head != 0) {
+			reverse(0, head);
+			reverse(head, N);
+			reverse(0, N);
+			head = 0;
+		}
+		return samples;
+	}
+
+private:
+	void reverse(uint8_t from, uint8_t to) {
+		while (from + 1 < to) {
+			int16_t tmp = samples[from];
+			samples[from++] = samples[--to];
+			samples[to] = tmp;
+		}
+	}
+
+	int16_t samples[N];  ///< Sample storage
+	uint16_t interval;   ///< Time between two samples in seconds
+	uint8_t head;        ///< Position of the next sample
+	uint8_t count;       ///< Number of samples
+	uint32_t time;       ///< Time of the newest sample in seconds
+};
+
+/**
+ * @brief Bit-granular writer for fields that do not need a whole number of bytes.
+ * Values are stored most significant bit first, so a 1-bit flag followed by a 7-bit value fills
+ * exactly one byte. Runs of whole bytes on a byte boundary are written without bit shuffling.
+ */
+class LppBitWriter {
+public:
+	/**
+	 * @brief Constructor for LppBitWriter class.
+	 * @param buffer Buffer the bits are written into.
+	 * @param size Size of the buffer in bytes.
+	 */
+	LppBitWriter(uint8_t *buffer, uint8_t size);
+
+	/**
+	 * @brief Start writing at the first bit of the buffer again.
+	 */
+	void reset(void);
+
+	/**
+	 * @brief Get the number of bytes used, including a partially filled last byte.
+	 * @return Number of bytes used.
+	 */
+	uint8_t getSize(void);
+
+	/**
+	 * @brief Get the number of bits written.
+	 * @return Number of bits written.
+	 */
+	uint16_t getBitCount(void);
+
+	/**
+	 * @brief Write the lower bits of an unsigned value.
+	 * @param value Value to be written.
+	 * @param bits Number of bits to write (32 max).
+	 * @return Number of bytes used, or 0 when the value does not fit.
+	 */
+	uint8_t write(uint32_t value, uint8_t bits);
+
+	/**
+	 * @brief Write a signed value in two's complement.
+	 * @param value Value to be written, it must fit in the given number of bits.
+	 * @param bits Number of bits to write (32 max).
+	 * @return Number of bytes used, or 0 when the value does not fit.
+	 */
+	uint8_t writeSigned(int32_t value, uint8_t bits);
+
+private:
+	uint8_t *buffer;   ///< Buffer the bits are written into
+	uint8_t maxsize;   ///< Size of the buffer in bytes
+	uint16_t bitpos;   ///< Number of bits written
+};
+
+/**
+ * @brief Bit-granular reader for frames written by LppBitWriter.
+ */
+class LppBitReader {
+public:
+	/**
+	 * @brief Constructor for LppBitReader class.
+	 * @param buffer Buffer the bits are read from.
+	 * @param size Size of the buffer in bytes.
+	 */
+	LppBitReader(const uint8_t *buffer, uint8_t size);
+
+	/**
+	 * @brief Get the number of bits that are left to read.
+	 * @return Number of bits left.
+	 */
+	uint16_t getRemaining(void);
+
+	/**
+	 * @brief Read an unsigned value.
+	 * @param bits Number of bits to read (32 max).
+	 * @return The value, or 0 when there are not enough bits left.
+	 */
+	uint32_t read(uint8_t bits);
+
+	/**
+	 * @brief Read a signed value stored in two's complement.
+	 * @param bits Number of bits to read (32 max).
+	 * @return The sign-extended value, or 0 when there are not enough bits left.
+	 */
+	int32_t readSigned(uint8_t bits);
+
+private:
+	const uint8_t *buffer;  ///< Buffer the bits are read from
+	uint8_t maxsize;        ///< Size of the buffer in bytes
+	uint16_t bitpos;        ///< Number of bits read
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,51 @@
+/*!
+ * \file KissUplinkSchema.h
+ * \brief Channels, ports and layout of the KISS LoRa uplinks.
+ * Generated by host/schema/lpp_schema.js from lpp_schema.json, do not edit.
+ * Change host/schema/lpp_schema.json and run node host/schema/lpp_schema.js, the same file
+ * generates the tables of payload.javascript, so the sketch and the decoder always agree.
+ */
+#ifndef _KISSUPLINKSCHEMA_H_
+#define _KISSUPLINKSCHEMA_H_
+
+#include "CustomCayeneLPP.h"
+
+#define LPP_CH_TEMPERATURE        0    ///< CayenneLPP CHannel for Temperature
+#define LPP_CH_HUMIDITY           1    ///< CayenneLPP CHannel for Humidity sensor
+#define LPP_CH_LUMINOSITY         2    ///< CayenneLPP CHannel for Luminosity sensor
+#define LPP_CH_ROTARYSWITCH       3    ///< CayenneLPP CHannel for Rotary switch
+#define LPP_CH_ACCELEROMETER      4    ///< CayenneLPP CHannel for Accelerometer
+#define LPP_CH_BOARDVCCVOLTAGE    5    ///< CayenneLPP CHannel for Processor voltage
+#define LPP_CH_PRESENCE           6    ///< CayenneLPP CHannel for Alarm
+#define LPP_CH_ADDBYTE            7    ///< CayenneLPP CHannel for a custom byte
+#define LPP_CH_ADD2BYTES          9    ///< CayenneLPP CHannel for a custom 2-byte value
+#define LPP_CH_ADD4BYTES          10   ///< CayenneLPP CHannel for a custom 4-byte value
+#define LPP_CH_CUSTOMBYTE         11   ///< CayenneLPP CHannel for a custom type 9 value
+#define LPP_CH_TEMPERATURE_SERIES 12   ///< CayenneLPP CHannel for the temperature samples between uplinks
+#define LPP_CH_SET_INTERVAL       20   ///< CayenneLPP CHannel for setting downlink interval
+#define LPP_CH_RESYNC             21   ///< CayenneLPP CHannel for requesting a delta keyframe by downlink
+#define LPP_CH_SW_RELEASE         90   ///< CayenneLPP CHannel for the software release
+
+#define APPLICATION_PORT_CAYENNE  99   ///< LoRaWAN port to which CayenneLPP packets shall be sent
+#define APPLICATION_PORT_PACKED   100  ///< LoRaWAN port to which packed KissUplinkSchema packets shall be sent
+#define APPLICATION_PORT_ALARM    101  ///< LoRaWAN port to which bit-packed alarm packets shall be sent
+#define APPLICATION_PORT_DELTA    102  ///< LoRaWAN port to which delta compressed KissUplinkSchema packets shall be sent
+#define APPLICATION_PORT_DEADBAND 103  ///< LoRaWAN port to which report-by-exception KissUplinkSchema packets shall be sent
+
+/// Layout of the regular uplink, one field per sensor in the order they are sent.
+typedef LppSchema<
+  LppTypeField<LPP_CH_TEMPERATURE,     LPP_TEMPERATURE>,
+  LppTypeField<LPP_CH_HUMIDITY,        LPP_RELATIVE_HUMIDITY>,
+  LppTypeField<LPP_CH_LUMINOSITY,      LPP_LUMINOSITY>,
+  LppTypeField<LPP_CH_ROTARYSWITCH,    LPP_DIGITAL_INPUT>,
+  LppTypeField<LPP_CH_ACCELEROMETER,   LPP_ACCELEROMETER>,
+  LppTypeField<LPP_CH_BOARDVCCVOLTAGE, LPP_ANALOG_INPUT>,
+  LppTypeField<LPP_CH_PRESENCE,        LPP_PRESENCE>,
+  LppTypeField<LPP_CH_SET_INTERVAL,    LPP_ANALOG_OUTPUT>
+> KissUplinkSchema;
+
+// AlarmSchema: Alarm frame, written with LppBitWriter. Fields with bits are scalars of that many bits, most significant bit first.
+#define ALARM_PRESENCE_BITS       1    ///< Bits used for the presence in the alarm frame
+#define ALARM_RELEASE_BITS        7    ///< Bits used for the software release in the alarm frame
+
+#endif
@@ -56,6 +56,9 @@ Go to **Tools->Processor** and select **ATmega32U4 (3.3V, 8MHz)**.
 //#include <CayenneLPP.h>         // include for CayenneLPP library
 #include "TheThingsNetwork.h" 
 #include "CustomCayeneLPP.h" // include for CayenneLPP_NewLibrary
+#include "LppDelta.h"        // include for keyframe and delta compression
+#include "LppDeadband.h"     // include for report-by-exception
+#include "KissUplinkSchema.h" // include for the layout of the regular uplink
 #include "SparkFun_Si7021_Breakout_Library.h" // include for temperature and humidity sensor
 #include <Wire.h>
 #include "KISSLoRa_sleep.h"     // Include to sleep MCU
@@ -84,30 +87,48 @@ TheThingsNetwork ttn(loraSerial, debugSerial, freqPlan);  // TTN object for LoRa
 //TheThingsNetwork ttn(loraSerial, debugSerial, freqPlan, 9);  // TTN object for LoRaWAN radio using SF9
 
 // Cayennel LPP
-#define APPLICATION_PORT_CAYENNE  99   ///< LoRaWAN port to which CayenneLPP packets shall be sent
-#define LPP_PAYLOAD_MAX_SIZE      51   ///< Maximum payload size of a LoRaWAN packet
+// Encoding of the regular uplink, the alarm uplink is only sent as LPP with UPLINK_LPP
+#define UPLINK_LPP                0    ///< Every uplink is a regular Cayenne LPP frame, readable by any LPP decoder
+#define UPLINK_PACKED             1    ///< Every uplink is a packed KissUplinkSchema frame
+#define UPLINK_DELTA              2    ///< Keyframes and deltas against the last keyframe, see LppDelta.h
+#define UPLINK_DEADBAND           3    ///< Only the fields that changed, see LppDeadband.h
+#define UPLINK_ENCODING           UPLINK_LPP
 
-#define LPP_CH_TEMPERATURE        0    ///< CayenneLPP CHannel for Temperature
-#define LPP_CH_HUMIDITY           1    ///< CayenneLPP CHannel for Humidity sensor
-#define LPP_CH_LUMINOSITY         2    ///< CayenneLPP CHannel for Luminosity sensor
-#define LPP_CH_ROTARYSWITCH       3    ///< CayenneLPP CHannel for Rotary switch
-#define LPP_CH_ACCELEROMETER      4    ///< CayenneLPP CHannel for Accelerometer
-#define LPP_CH_BOARDVCCVOLTAGE    5    ///< CayenneLPP CHannel for Processor voltage
-#define LPP_CH_PRESENCE           6    ///< CayenneLPP CHannel for Alarm
+#define DELTA_KEYFRAME_INTERVAL   10   ///< Number of uplinks between delta keyframes
+#define DEADBAND_HEARTBEAT        30   ///< Every field is sent at least once every DEADBAND_HEARTBEAT uplinks
 
+#define ENCODER_BENCHMARK         0    ///< Set to 1 to print the cycles of the float and integer encode paths at startup
 
-#define LPP_CH_ADDBYTE            7
-#define LLP_CH_ADD2BYTES          9
-#define LPP_CH_ADD4BYTES          10
-#define LPP_CH_CUSTOMBYTE         11
-
-#define LPP_CH_SET_INTERVAL       20   ///< CayenneLPP CHannel for setting downlink interval
-#define LPP_CH_SW_RELEASE         90   ///< 
+// The LoRaWAN ports, the LPP_CH_ channels and the alarm frame layout are in KissUplinkSchema.h,
+// generated from host/schema/lpp_schema.json together with the tables of payload.javascript
 
 #define ALARM                     0x01 ///< Alarm state
 #define SAFE                      0x00 ///< No-alarm state
 
-CayenneLPP lpp(LPP_PAYLOAD_MAX_SIZE);  ///< Cayenne object for composing sensor message
+StaticCayenneLPP<LPP_PAYLOAD_MAX_SIZE> lpp;  ///< Cayenne object for composing sensor message, without heap use
+LppDeltaEncoder delta(KissUplinkSchema::count, DELTA_KEYFRAME_INTERVAL);  ///< Delta state of the regular uplink
+
+/// Change of every KissUplinkSchema field, in scaled units, that is not worth an uplink
+const uint16_t uplinkDeadbands[KissUplinkSchema::fields] = {
+  5,    // temperature: 0.5 C
+  4,    // humidity: 2 %RH
+  20,   // luminosity: 20 lux
+  0,    // rotary switch: every change
+  100,  // accelerometer: 0.1 g per axis
+  5,    // VDD: 0.05 V
+  0,    // presence: every change
+  0     // interval: every change
+};
+LppDeadbandEncoder deadband(KissUplinkSchema::axes, uplinkDeadbands, KissUplinkSchema::fields, DEADBAND_HEARTBEAT);  ///< Report-by-exception state of the regular uplink
+
+// Temperature samples taken between uplinks, sent as one LPP_TIMESERIES record
+#define SAMPLE_INTERVAL           60000 ///< Interval between temperature samples in ms
+#define SAMPLE_COUNT              8     ///< Maximum number of samples per uplink, older samples are dropped
+#define SAMPLE_WIDTH              2     ///< Bytes per sample in the LPP_TIMESERIES record
+
+LppSampleRing<SAMPLE_COUNT> temperatureSeries(SAMPLE_INTERVAL / 1000);  ///< Temperature samples in 0.1 °C
+uint32_t sampleClockMs = 0;       ///< Time spent in sleep(), used as time base for the samples
+uint32_t lastSampleMs  = 0;       ///< sampleClockMs at the last sample
 
 // Sensors
 Weather sensor;                        ///< temperature and humidity sensor
@@ -132,7 +153,7 @@ Weather sensor;                        ///< temperature and humidity sensor
 // defines for accelerometer
 #define ACC_RANGE         2       ///< Set up to read the accelerometer values in range -2g to +2g - valid ranges: �2G,�4G or �8G
 
-float x,y,z;                      ///< Variables to hold acellerometer axis values.
+int16_t x,y,z;                    ///< Variables to hold acellerometer axis values in mG.
 
 // Set up application specific
 #define REGULAR_INTERVAL  60000   ///< Regular transmission interval in ms
@@ -201,6 +222,10 @@ void setup(){
   initAccelerometer();
   setAccelerometerRange(ACC_RANGE); 
 
+#if ENCODER_BENCHMARK
+  benchmarkEncoder();
+#endif
+
   // Initialize LoRaWAN radio
   digitalWrite(RGBLED_RED, LOW);    //switch RGBLED_RED LED on
     
@@ -233,23 +258,25 @@ void loop(){
   digitalWrite(RGBLED_GREEN, HIGH); //switch RGBLED_GREEN LED off
   digitalWrite(RGBLED_BLUE, HIGH);  //switch RGBLED_BLUE LED off
 
-  // Measure Relative Humidity from the Si7021
-  float humidity = sensor.getRH();
+  // All readings are integers in fixed point, so the encoder does not need the float library
+
+  // Measure Relative Humidity from the Si7021 in 0.01 %RH
+  int16_t humidity = sensor.getRHCenti();
   debugSerial.print(F("Humidity: "));
-  debugSerial.print(humidity);
+  printFixed(humidity, 2);
   debugSerial.println(F(" %RH."));
 
-  // Measure Temperature from the Si7021
-  float temperature = sensor.getTemp();
+  // Measure Temperature from the Si7021 in 0.01 degrees
+  int16_t temperature = sensor.getTempCenti();
   // Temperature is measured every time RH is requested.
   // It is faster, therefore, to read it from previous RH
   // measurement with getTemp() instead with readTemp()
   debugSerial.print(F("Temperature: "));
-  debugSerial.print(temperature);
+  printFixed(temperature, 2);
   debugSerial.println(F(" Degrees."));
 
   // Measure luminosity
-  float luminosity = get_lux_value();
+  uint16_t luminosity = get_lux_value();
   Serial.print(F("Ambient light: "));
   Serial.print(luminosity);
   Serial.println(F(" lux"));
@@ -262,17 +289,17 @@ void loop(){
   /// get accelerometer
   getAcceleration(&x, &y, &z);
   Serial.print(F("Acceleration:\tx="));
-  Serial.print(x);
+  printFixed(x, 3);
   Serial.print(F("g\n\t\ty="));
-  Serial.print(y);
+  printFixed(y, 3);
   Serial.print(F("g\n\t\tz="));
-  Serial.print(z);
+  printFixed(z, 3);
   Serial.println(F("g"));
 
-  /// get VDD form RN module
-  float vdd = (float)ttn.getVDD()/1000;
+  /// get VDD form RN module in mV
+  uint16_t vdd = ttn.getVDD();
   Serial.print(F("RN2483 voltage: "));
-  Serial.print(vdd);
+  printFixed(vdd, 3);
   Serial.println(F(" Volt"));
   
   // Wake RN2483 
@@ -294,22 +321,75 @@ void loop(){
   //lpp.add2Bytes(LPP_CH_TEMPERATURE,LPP_TEMPERATURE, temperature, 10);
   //lpp.addCustomByte(LPP_CH_CUSTOMBYTE, LPP_CUSTOMBYTE, custom, 10, 2);
 
-  lpp.addWord(LPP_CH_TEMPERATURE, LPP_TEMPERATURE, temperature, 10);
-  lpp.addByte(LPP_CH_HUMIDITY, LPP_RELATIVE_HUMIDITY, humidity, 2);
-  lpp.addWord(LPP_CH_LUMINOSITY, LPP_LUMINOSITY, luminosity, 1);
-  lpp.addByte(LPP_CH_ROTARYSWITCH, LPP_DIGITAL_INPUT, rotaryPosition, 1);
-  lpp.add3Float(LPP_CH_ACCELEROMETER, LPP_ACCELEROMETER, x, y, z, 1000);
-  lpp.addWord(LPP_CH_BOARDVCCVOLTAGE, LPP_ANALOG_INPUT, vdd, 100);
-  lpp.addByte(LPP_CH_PRESENCE, LPP_PRESENCE, SAFE, 1);
-  lpp.addWord(LPP_CH_SET_INTERVAL, LPP_ANALOG_OUTPUT, (float)currentInterval/1000, 100);
-
-  Serial.print("lpp.getSize()");
-  Serial.println(lpp.getSize());
+#if UPLINK_ENCODING == UPLINK_DELTA
+  int32_t values[KissUplinkSchema::count];
+  KissUplinkSchema::scale(values, lppScaled(temperature, -1), lppScaled((humidity + 25) / 50), luminosity, rotaryPosition,
+                          lppScaled(x), lppScaled(y), lppScaled(z), lppScaled(vdd, -1), SAFE,
+                          lppScaled(currentInterval, -1));
+  // Encode straight into the packet, only the bytes used are committed
+  uint8_t *frame = lpp.reserve(lpp.getAvailable());
+  lpp.commit(delta.encode(values, frame, lpp.getAvailable()));
+  port_t payloadPort = APPLICATION_PORT_DELTA;
+#elif UPLINK_ENCODING == UPLINK_DEADBAND
+  int32_t values[KissUplinkSchema::count];
+  KissUplinkSchema::scale(values, lppScaled(temperature, -1), lppScaled((humidity + 25) / 50), luminosity, rotaryPosition,
+                          lppScaled(x), lppScaled(y), lppScaled(z), lppScaled(vdd, -1), SAFE,
+                          lppScaled(currentInterval, -1));
+  // Encode straight into the packet, only the bytes used are committed
+  uint8_t *frame = lpp.reserve(lpp.getAvailable());
+  lpp.commit(deadband.encode(values, frame, lpp.getAvailable()));
+  port_t payloadPort = APPLICATION_PORT_DEADBAND;
+#elif UPLINK_ENCODING == UPLINK_PACKED
+  lpp.addSchemaPacked<KissUplinkSchema>(lppScaled(temperature, -1), lppScaled((humidity + 25) / 50), luminosity, rotaryPosition,
+                                        lppScaled(x), lppScaled(y), lppScaled(z), lppScaled(vdd, -1), SAFE,
+                                        lppScaled(currentInterval, -1));
+  port_t payloadPort = APPLICATION_PORT_PACKED;
+#else
+  lpp.addSchema<KissUplinkSchema>(lppScaled(temperature, -1), lppScaled((humidity + 25) / 50), luminosity, rotaryPosition,
+                                  lppScaled(x), lppScaled(y), lppScaled(z), lppScaled(vdd, -1), SAFE,
+                                  lppScaled(currentInterval, -1));
+  port_t payloadPort = APPLICATION_PORT_CAYENNE;
+#endif
+  bool quiet = false;
+#if UPLINK_ENCODING == UPLINK_DEADBAND
+  // Skip the uplink when no field changed, unless the temperature samples would be lost
+  quiet = (deadband.getReported() == 0) && (temperatureSeries.getCount() < SAMPLE_COUNT);
+#endif
+
+  // Append the temperature samples taken since the last uplink. Only the newest samples that fit
+  // in the rest of the payload are sent, the older ones are dropped.
+  if(!quiet && temperatureSeries.getCount() > 0){
+    uint8_t taken = temperatureSeries.getCount();
+    uint8_t count = lpp.getAvailable() > LPP_TIMESERIES_SIZE ? (lpp.getAvailable() - LPP_TIMESERIES_SIZE) / SAMPLE_WIDTH : 0;
+    if(count > taken){
+      count = taken;
+    }
+    const int16_t *samples = temperatureSeries.linearize() + (taken - count);
+    uint32_t baseTime = temperatureSeries.getBaseTime() + (uint32_t)(taken - count) * temperatureSeries.getInterval();
+    if(count > 0 && lpp.addTimeSeries(LPP_CH_TEMPERATURE_SERIES, LPP_TEMPERATURE, SAMPLE_WIDTH, baseTime,
+                                      temperatureSeries.getInterval(), samples, count)){
+      if(count < taken){
+        debugSerial.print(F("Temperature samples dropped: "));
+        debugSerial.println(taken - count);
+      }
+      temperatureSeries.reset();
+    }else{
+      debugSerial.println(F("Temperature samples do not fit in the uplink."));
+    }
+  }
+  LppSpan payload = lpp.getSpan();
+
+  Serial.print("payload size: ");
+  Serial.println(payload.size);
   
   digitalWrite(LED_LORA, LOW);  //switch LED_LORA LED on
 
-  // send cayenne message on port 99
-  ttn.sendBytes(lpp.getBuffer(), lpp.getSize(), APPLICATION_PORT_CAYENNE);
+  // send message on the port that identifies the encoding
+  if(quiet){
+    debugSerial.println(F("Nothing changed, uplink skipped."));
+  }else{
+    ttn.sendBytes(payload.data, payload.size, payloadPort);
+  }
 
   // Set RN2483 to sleep mode
   ttn.sleep(currentInterval - 100);
@@ -343,6 +423,10 @@ void message(const uint8_t *payload, size_t size, port_t port)
         debugSerial.print("New interval: " + String(nextInterval/1000));
         debugSerial.println(F(" Seconds"));
         digitalWrite(RGBLED_BLUE, !digitalRead(RGBLED_BLUE));
+      }else if(payload[0] == LPP_CH_RESYNC){
+        delta.requestKeyframe();
+        deadband.requestFull();
+        debugSerial.println(F("Keyframe requested."));
       }else{
         debugSerial.println(F("Wrong downlink message."));
       }
@@ -363,12 +447,15 @@ void message(const uint8_t *payload, size_t size, port_t port)
 /// \brief read luminosty value from sensor
 ///  Get the lux value from the APDS-9007 Ambient Light Photo Sensor
 /// \return luminosity in Lux.
-float get_lux_value(void){
-  int digital_value = analogRead(LIGHT_SENSOR_PIN);
-  double vlux = digital_value * (2.56/1023.0); //lux value in volts
-  double ilux = (vlux / 56) * 1000;            //lux value in micro amperes
-  double lux = pow(10, (ilux / 10));           //Convert ilux to Lux value
-  return (float)lux;                        //Return Lux value as value without decimal
+uint16_t get_lux_value(void){
+  // lux = 10^(ilux / 10) with ilux = (adc * 2.56 / 1023) / 56 * 1000 micro amperes.
+  // That is 2^(adc * 0.014845), computed in fixed point: 3891 / 1024 = 0.014845 * 256.
+  static const uint16_t pow2_q12[9] = {4096, 4467, 4871, 5312, 5793, 6317, 6889, 7512, 8192}; // 2^(k/8) * 4096
+  uint16_t exponent = ((uint32_t)analogRead(LIGHT_SENSOR_PIN) * 3891) >> 10;  // 2-log of lux * 256
+  uint8_t fraction = exponent & 0xFF;
+  uint8_t k = fraction >> 5;
+  uint32_t mantissa = pow2_q12[k] + (((uint32_t)(pow2_q12[k + 1] - pow2_q12[k]) * (fraction & 0x1F)) >> 5);
+  return (mantissa << (exponent >> 8)) >> 12;  //Return Lux value as value without decimal
 }
 
 /// \brief read rotary switch value
@@ -452,7 +539,7 @@ static void setAccelerometerRange(uint8_t range_g){
 /// \param x pointer to x-value
 /// \param y pointer to y-value
 /// \param z pointer to z-value
-void getAcceleration(float *x, float *y, float *z){
+void getAcceleration(int16_t *x, int16_t *y, int16_t *z){
   // Resource: https://github.com/sparkfun/MMA8452_Accelerometer/blob/master/Libraries/Arduino/src/SparkFun_MMA8452Q.cpp
   // Read the acceleration from registers 1 through 6 of the MMA8452 accelerometer.
   // 2 registers per axis, 12 bits per axis.
@@ -461,12 +548,12 @@ void getAcceleration(float *x, float *y, float *z){
   *y = ((short)(readAccelerometer(3)<<8 | readAccelerometer(4))) >> 4;
   *z = ((short)(readAccelerometer(5)<<8 | readAccelerometer(6))) >> 4;
 
-  // Scale 12 bit signed values to units of g. The default measurement range is �2g.
+  // Scale 12 bit signed values to units of mG. The default measurement range is �2g.
   // That is 11 bits for positive values and 11 bits for negative values.
-  // value = (value / (2^11)) * 2
-  *x = (float)*x / (float)(1<<11) * (float)(ACC_RANGE);
-  *y = (float)*y / (float)(1<<11) * (float)(ACC_RANGE);
-  *z = (float)*z / (float)(1<<11) * (float)(ACC_RANGE);
+  // value = (value / (2^11)) * 2 * 1000 mG
+  *x = (int32_t)*x * ACC_RANGE * 1000 / (1<<11);
+  *y = (int32_t)*y * ACC_RANGE * 1000 / (1<<11);
+  *z = (int32_t)*z * ACC_RANGE * 1000 / (1<<11);
 }
 
 /// \brief Sleep until a given time has passed, or if the push button is pressed, or if rotary switch is changed
@@ -490,12 +577,23 @@ static void sleep(uint32_t delay_time_ms){
       // Wake RN2483 
       ttn.wake();
         
+#if UPLINK_ENCODING != UPLINK_LPP
+      // Alarm state and software release share a single byte
+      uint8_t alarmFrame[1];
+      LppBitWriter bits(alarmFrame, sizeof(alarmFrame));
+      bits.write(ALARM, ALARM_PRESENCE_BITS);
+      bits.write(RELEASE, ALARM_RELEASE_BITS);
+  
+      // Send it off
+      ttn.sendBytes(alarmFrame, bits.getSize(), APPLICATION_PORT_ALARM, true);
+#else
       lpp.reset();
       lpp.addByte(LPP_CH_PRESENCE, LPP_PRESENCE, ALARM, 1);
       lpp.addByte(LPP_CH_SW_RELEASE, LPP_DIGITAL_INPUT, RELEASE, 1);
-  
+
       // Send it off
       ttn.sendBytes(lpp.getBuffer(), lpp.getSize(), APPLICATION_PORT_CAYENNE, true);
+#endif
 
       // Set RN2483 to sleep mode
       ttn.sleep(delay_time_ms - 2200);
@@ -508,6 +606,8 @@ static void sleep(uint32_t delay_time_ms){
       digitalWrite(RGBLED_RED, HIGH);  //switch RGBLED_RED LED off
     }
 
+    sampleTemperature(100);
+
     if(delay_time_ms > 100){
       delay_time_ms -= 100;
     }else{
@@ -516,6 +616,86 @@ static void sleep(uint32_t delay_time_ms){
   }
 }
 
+/// \brief Add a temperature sample to temperatureSeries when SAMPLE_INTERVAL has passed
+/// \param elapsed_ms time in ms passed since the previous call.
+static void sampleTemperature(uint32_t elapsed_ms){
+  sampleClockMs += elapsed_ms;
+  if(sampleClockMs - lastSampleMs >= SAMPLE_INTERVAL){
+    lastSampleMs = sampleClockMs;
+    temperatureSeries.push((int16_t)lppScale(sensor.getTempCenti(), -1), sampleClockMs / 1000);
+  }
+}
+
+#if ENCODER_BENCHMARK
+/// \brief Count the CPU cycles of the float and the integer encode path using Timer1 at clk/1
+/// Inputs are volatile, so the compiler can not fold the scaling at compile time.
+static void benchmarkEncoder(void){
+  volatile float fTemperature = 21.53, fHumidity = 40.12, fX = 0.1, fY = -0.2, fZ = 1.0, fVdd = 3.3, fInterval = 60;
+  volatile int16_t iTemperature = 2153, iHumidity = 4012, iX = 100, iY = -200, iZ = 1000;
+  volatile uint16_t iVdd = 3300;
+  volatile uint32_t iInterval = 60000;
+  uint8_t savedA = TCCR1A, savedB = TCCR1B;
+  uint16_t start, floatWord, intWord, floatSchema, intSchema;
+
+  TCCR1A = 0;
+  TCCR1B = (1 << CS10);   // count every CPU cycle
+
+  lpp.reset();
+  start = TCNT1;
+  lpp.addWord(LPP_CH_TEMPERATURE, LPP_TEMPERATURE, fTemperature, 10);
+  floatWord = TCNT1 - start;
+
+  lpp.reset();
+  start = TCNT1;
+  lpp.addWord(LPP_CH_TEMPERATURE, LPP_TEMPERATURE, (int16_t)lppScale(iTemperature, -1));
+  intWord = TCNT1 - start;
+
+  lpp.reset();
+  start = TCNT1;
+  lpp.addSchemaPacked<KissUplinkSchema>(fTemperature, fHumidity, 300, 5, fX, fY, fZ, fVdd, SAFE, fInterval);
+  floatSchema = TCNT1 - start;
+
+  lpp.reset();
+  start = TCNT1;
+  lpp.addSchemaPacked<KissUplinkSchema>(lppScaled(iTemperature, -1), lppScaled((iHumidity + 25) / 50), 300, 5,
+                                        lppScaled(iX), lppScaled(iY), lppScaled(iZ), lppScaled(iVdd, -1), SAFE,
+                                        lppScaled(iInterval, -1));
+  intSchema = TCNT1 - start;
+
+  TCCR1A = savedA;
+  TCCR1B = savedB;
+  lpp.reset();
+
+  debugSerial.print(F("Cycles addWord float/int: "));
+  debugSerial.print(floatWord);
+  debugSerial.print('/');
+  debugSerial.println(intWord);
+  debugSerial.print(F("Cycles KissUplinkSchema float/int: "));
+  debugSerial.print(floatSchema);
+  debugSerial.print('/');
+  debugSerial.println(intSchema);
+}
+#endif
+
+/// \brief Print a fixed-point value with a decimal point, without the float library
+/// \param value value in units of 10^-decimals.
+/// \param decimals number of decimals.
+static void printFixed(int32_t value, uint8_t decimals){
+  int32_t factor = lppScale(1, decimals);
+  int32_t fraction;
+  if(value < 0){
+    debugSerial.print('-');
+    value = -value;
+  }
+  debugSerial.print(value / factor);
+  debugSerial.print('.');
+  fraction = value % factor;
+  for(factor /= 10; factor > fraction && factor > 1; factor /= 10){
+    debugSerial.print('0');   // leading zeros of the decimals
+  }
+  debugSerial.print(fraction);
+}
+
 /// \brief Determine interval in ms using rotary value
 /// \pre This function is only using bits 4, 2, and 1 while ignoring bit 8.
 /// Set this using define INTERVAL_ROTARY_MASK
@@ -0,0 +1,79 @@
+#include "LppDeadband.h"
+#include "LppDelta.h"
+
+LppDeadbandEncoder::LppDeadbandEncoder(const uint8_t *axes, const uint16_t *deadbands, uint8_t fields, uint8_t heartbeat)
+: axes(axes), deadbands(deadbands), heartbeat(heartbeat) {
+	uint8_t count = 0;
+
+	// Drop the fields that do not fit in the state
+	this->fields = 0;
+	while (this->fields < fields && this->fields < LPP_DEADBAND_MAX_FIELDS
+	       && (count + axes[this->fields]) <= LPP_DEADBAND_MAX_VALUES) {
+		count += axes[this->fields++];
+	}
+	memset(silence, 0, sizeof(silence));
+	reported = 0;
+	forceFull = true;
+}
+
+void LppDeadbandEncoder::requestFull(void) {
+	forceFull = true;
+}
+
+uint8_t LppDeadbandEncoder::encode(const int32_t *values, uint8_t *buffer, uint8_t size) {
+	uint8_t bitmapSize = (fields + 7) >> 3;
+	uint8_t tmp[LPP_DELTA_VARINT_MAX_SIZE];
+	uint8_t cursor = bitmapSize;
+	uint8_t count = 0;
+	uint8_t n = 0;
+
+	if (size < bitmapSize) {
+		return 0;
+	}
+	memset(buffer, 0, bitmapSize);
+
+	for (uint8_t f = 0; f < fields; f++) {
+		bool send = forceFull || (silence[f] + 1) >= heartbeat;
+
+		for (uint8_t a = 0; a < axes[f] && !send; a++) {
+			// Unsigned difference, so values far apart do not overflow
+			uint32_t diff = (values[n + a] > last[n + a]) ? (uint32_t)values[n + a] - (uint32_t)last[n + a]
+			                                              : (uint32_t)last[n + a] - (uint32_t)values[n + a];
+			send = diff > deadbands[f];
+		}
+		if (send) {
+			for (uint8_t a = 0; a < axes[f]; a++) {
+				uint8_t length = lppWriteVarint(values[n + a], tmp);
+
+				if ((cursor + length) > size) {
+					return 0;
+				}
+				memcpy(buffer + cursor, tmp, length);
+				cursor += length;
+			}
+			buffer[f >> 3] |= 0x80 >> (f & 0x07);
+			count++;
+		}
+		n += axes[f];
+	}
+
+	// Only commit the state once the frame is complete
+	n = 0;
+	for (uint8_t f = 0; f < fields; f++) {
+		if (buffer[f >> 3] & (0x80 >> (f & 0x07))) {
+			memcpy(last + n, values + n, axes[f] * sizeof(int32_t));
+			silence[f] = 0;
+		} else {
+			silence[f]++;
+		}
+		n += axes[f];
+	}
+	forceFull = false;
+	reported = count;
+
+	return cursor;
+}
+
+uint8_t LppDeadbandEncoder::getReported(void) {
+	return reported;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file  LppDeadband.h
+ * @brief Report-by-exception of LPP values: only fields that changed are sent.
+ * @note  Values are the scaled integers of an LppSchema, see LppSchema::scale().
+ * @copyright (c) 2024, Leon Nguyen and Len Verploegen
+ *
+ * The MIT License (MIT), see CustomCayeneLPP.h.
+ *
+ * Frame layout:
+ *
+ * Byte | Content
+ * -----|--------------------------------------------------------------------
+ * 0..  | bitmap with one bit per field, most significant bit of the first byte is field 0
+ * ..   | for every field with its bit set: one zigzag varint per value, absolute
+ *
+ * A field is sent when one of its values moved more than its deadband away from the value last sent,
+ * or when it was left out heartbeat frames in a row. The receiver carries the last known value of an
+ * omitted field forward, the heartbeat limits how long a lost frame can leave it wrong.
+ *
+ * @author  Leon Nguyen and Len Verpleogen
+ */
+#ifndef _LPPDEADBAND_H_
+#define _LPPDEADBAND_H_
+
+#include <Arduino.h>
+
+#define LPP_DEADBAND_MAX_FIELDS 16    /// \ Maximum number of fields in a deadband frame
+#define LPP_DEADBAND_MAX_VALUES 16    /// \ Maximum number of values in a deadband frame
+
+/**
+ * @brief Stateful encoder that leaves out the fields that did not change.
+ */
+class LppDeadbandEncoder {
+public:
+	/**
+	 * @brief Constructor for LppDeadbandEncoder class.
+	 * @param axes Number of values of every field, for example LppSchema::axes.
+	 * @param deadbands Largest change of a value, in scaled units, that is not reported. One per field.
+	 * @param fields Number of fields (LPP_DEADBAND_MAX_FIELDS max).
+	 * @param heartbeat A field is sent at least once every heartbeat frames.
+	 */
+	LppDeadbandEncoder(const uint8_t *axes, const uint16_t *deadbands, uint8_t fields, uint8_t heartbeat);
+
+	/**
+	 * @brief Send all fields in the next frame, for example when the receiver lost its state.
+	 */
+	void requestFull(void);
+
+	/**
+	 * @brief Encode the fields that changed.
+	 * @param values Array with the scaled values of all fields.
+	 * @param buffer Buffer the frame is written into.
+	 * @param size Size of the buffer.
+	 * @return Size of the frame, or 0 when the frame does not fit. The state is not changed then.
+	 */
+	uint8_t encode(const int32_t *values, uint8_t *buffer, uint8_t size);
+
+	/**
+	 * @brief Get the number of fields in the last frame.
+	 * @return Number of fields, 0 when nothing changed and the uplink can be skipped.
+	 */
+	uint8_t getReported(void);
+
+private:
+	int32_t last[LPP_DEADBAND_MAX_VALUES];    ///< Values last sent
+	uint8_t silence[LPP_DEADBAND_MAX_FIELDS]; ///< Frames since every field was last sent
+	const uint8_t *axes;                      ///< Number of values of every field
+	const uint16_t *deadbands;                ///< Deadband of every field
+	uint8_t fields;                           ///< Number of fields
+	uint8_t heartbeat;                        ///< Maximum number of frames a field is left out
+	uint8_t reported;                         ///< Number of fields in the last frame
+	bool forceFull;                           ///< The next frame must contain all fields
+};
+
+#endif
@@ -0,0 +1,132 @@
+#include "LppDelta.h"
+
+uint8_t lppWriteVarint(int32_t value, uint8_t *buffer) {
+	// Zigzag maps small negative and positive values to small unsigned values
+	uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+	uint8_t size = 0;
+
+	while (zigzag >= 0x80) {
+		buffer[size++] = (zigzag & 0x7F) | 0x80;  // More bytes follow
+		zigzag >>= 7;
+	}
+	buffer[size++] = zigzag;
+
+	return size;
+}
+
+uint8_t lppReadVarint(const uint8_t *buffer, uint8_t size, int32_t *value) {
+	uint32_t zigzag = 0;
+
+	for (uint8_t i = 0; i < size && i < LPP_DELTA_VARINT_MAX_SIZE; i++) {
+		zigzag |= (uint32_t)(buffer[i] & 0x7F) << (7 * i);
+		if (!(buffer[i] & 0x80)) {
+			*value = (int32_t)((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+			return i + 1;
+		}
+	}
+	return 0;
+}
+
+LppDeltaEncoder::LppDeltaEncoder(uint8_t count, uint8_t keyframeInterval)
+: count(count), keyframeInterval(keyframeInterval) {
+	if (this->count > LPP_DELTA_MAX_VALUES) {
+		this->count = LPP_DELTA_MAX_VALUES;
+	}
+	sinceKeyframe = 0;
+	keyframeId = LPP_DELTA_ID_MASK;  // First keyframe gets id 0
+	counter = 0;
+	forceKeyframe = true;
+}
+
+void LppDeltaEncoder::requestKeyframe(void) {
+	forceKeyframe = true;
+}
+
+uint8_t LppDeltaEncoder::encode(const int32_t *values, uint8_t *buffer, uint8_t size) {
+	bool isKeyframe = forceKeyframe || (sinceKeyframe >= keyframeInterval);
+	uint8_t id = isKeyframe ? ((keyframeId + 1) & LPP_DELTA_ID_MASK) : keyframeId;
+	uint8_t tmp[LPP_DELTA_VARINT_MAX_SIZE];
+	uint8_t cursor = LPP_DELTA_HEADER_SIZE;
+
+	if (size < LPP_DELTA_HEADER_SIZE) {
+		return 0;
+	}
+	buffer[0] = (isKeyframe ? LPP_DELTA_KEYFRAME : 0) | id;
+	buffer[1] = counter;
+
+	for (uint8_t i = 0; i < count; i++) {
+		int32_t value = isKeyframe ? values[i] : (int32_t)((uint32_t)values[i] - (uint32_t)keyframe[i]);
+		uint8_t length = lppWriteVarint(value, tmp);
+
+		if ((cursor + length) > size) {
+			return 0;
+		}
+		memcpy(buffer + cursor, tmp, length);
+		cursor += length;
+	}
+
+	// Only commit the state once the frame is complete
+	if (isKeyframe) {
+		memcpy(keyframe, values, count * sizeof(int32_t));
+		keyframeId = id;
+		sinceKeyframe = 0;
+		forceKeyframe = false;
+	}
+	sinceKeyframe++;
+	counter++;
+
+	return cursor;
+}
+
+LppDeltaDecoder::LppDeltaDecoder(uint8_t count)
+: count(count) {
+	if (this->count > LPP_DELTA_MAX_VALUES) {
+		this->count = LPP_DELTA_MAX_VALUES;
+	}
+	keyframeId = 0;
+	counter = 0;
+	lostFrames = 0;
+	hasKeyframe = false;
+	hasCounter = false;
+}
+
+lpp_delta_result_t LppDeltaDecoder::decode(const uint8_t *frame, uint8_t size, int32_t *values) {
+	if (size < LPP_DELTA_HEADER_SIZE) {
+		return LPP_DELTA_INVALID;
+	}
+
+	bool isKeyframe = frame[0] & LPP_DELTA_KEYFRAME;
+	uint8_t id = frame[0] & LPP_DELTA_ID_MASK;
+	uint8_t cursor = LPP_DELTA_HEADER_SIZE;
+
+	lostFrames = hasCounter ? (uint8_t)(frame[1] - counter - 1) : 0;
+	counter = frame[1];
+	hasCounter = true;
+
+	if (!isKeyframe && (!hasKeyframe || id != keyframeId)) {
+		return LPP_DELTA_RESYNC;
+	}
+
+	for (uint8_t i = 0; i < count; i++) {
+		int32_t value;
+		uint8_t length = lppReadVarint(frame + cursor, size - cursor, &value);
+
+		if (length == 0) {
+			return LPP_DELTA_INVALID;
+		}
+		values[i] = isKeyframe ? value : (int32_t)((uint32_t)keyframe[i] + (uint32_t)value);
+		cursor += length;
+	}
+
+	if (isKeyframe) {
+		memcpy(keyframe, values, count * sizeof(int32_t));
+		keyframeId = id;
+		hasKeyframe = true;
+	}
+
+	return LPP_DELTA_OK;
+}
+
+uint8_t LppDeltaDecoder::getLostFrames(void) {
+	return lostFrames;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file  LppDelta.h
+ * @brief Keyframe and delta compression of LPP values across uplinks.
+ * @note  Values are the scaled integers of an LppSchema, see LppSchema::scale().
+ * @copyright (c) 2024, Leon Nguyen and Len Verploegen
+ *
+ * The MIT License (MIT), see CustomCayeneLPP.h.
+ *
+ * Frame layout:
+ *
+ * Byte | Content
+ * -----|--------------------------------------------------------------------
+ * 0    | bit 7: keyframe flag, bit 0..6: keyframe id
+ * 1    | frame counter, incremented for every frame
+ * 2..  | one zigzag varint per value, absolute in a keyframe, else the difference with the keyframe
+ *
+ * Deltas are taken against the last keyframe and not against the previous frame, so a lost delta frame
+ * does not affect the frames after it. A lost keyframe is detected by the keyframe id, the decoder then
+ * has to ask the device for a new keyframe.
+ *
+ * @author  Leon Nguyen and Len Verpleogen
+ */
+#ifndef _LPPDELTA_H_
+#define _LPPDELTA_H_
+
+#include <Arduino.h>
+
+#define LPP_DELTA_MAX_VALUES 16       /// \ Maximum number of values in a delta frame
+#define LPP_DELTA_HEADER_SIZE 2       /// \ Keyframe flag and id, frame counter
+#define LPP_DELTA_KEYFRAME 0x80       /// \ Keyframe flag in the first header byte
+#define LPP_DELTA_ID_MASK 0x7F        /// \ Keyframe id in the first header byte
+#define LPP_DELTA_VARINT_MAX_SIZE 5   /// \ Maximum size of a 32-bit varint
+
+/**
+ * @brief Result of LppDeltaDecoder::decode().
+ */
+enum lpp_delta_result_t
+{
+	LPP_DELTA_OK = 0,         ///< Values decoded
+	LPP_DELTA_RESYNC = (-1),  ///< Delta frame against an unknown keyframe, a new keyframe is needed
+	LPP_DELTA_INVALID = (-2)  ///< Frame is truncated or malformed
+};
+
+/**
+ * @brief Stateful encoder producing keyframes and delta frames.
+ */
+class LppDeltaEncoder {
+public:
+	/**
+	 * @brief Constructor for LppDeltaEncoder class.
+	 * @param count Number of values in every frame (LPP_DELTA_MAX_VALUES max).
+	 * @param keyframeInterval A keyframe is sent every keyframeInterval frames.
+	 */
+	LppDeltaEncoder(uint8_t count, uint8_t keyframeInterval);
+
+	/**
+	 * @brief Make the next frame a keyframe, for example when the decoder asked for a resync.
+	 */
+	void requestKeyframe(void);
+
+	/**
+	 * @brief Encode the values as a keyframe or as a delta frame.
+	 * @param values Array of count scaled values.
+	 * @param buffer Buffer the frame is written into.
+	 * @param size Size of the buffer.
+	 * @return Size of the frame, or 0 when the frame does not fit. The state is not changed then.
+	 */
+	uint8_t encode(const int32_t *values, uint8_t *buffer, uint8_t size);
+
+private:
+	int32_t keyframe[LPP_DELTA_MAX_VALUES];  ///< Values of the last keyframe
+	uint8_t count;                           ///< Number of values in every frame
+	uint8_t keyframeInterval;                ///< Number of frames between keyframes
+	uint8_t sinceKeyframe;                   ///< Number of frames since the last keyframe
+	uint8_t keyframeId;                      ///< Id of the last keyframe
+	uint8_t counter;                         ///< Frame counter
+	bool forceKeyframe;                      ///< The next frame must be a keyframe
+};
+
+/**
+ * @brief Stateful decoder for frames produced by LppDeltaEncoder.
+ */
+class LppDeltaDecoder {
+public:
+	/**
+	 * @brief Constructor for LppDeltaDecoder class.
+	 * @param count Number of values in every frame (LPP_DELTA_MAX_VALUES max).
+	 */
+	LppDeltaDecoder(uint8_t count);
+
+	/**
+	 * @brief Decode a frame into absolute values.
+	 * @param frame The received frame.
+	 * @param size Size of the frame.
+	 * @param values Array of count values the result is written into.
+	 * @return LPP_DELTA_OK, or the reason the values could not be decoded.
+	 */
+	lpp_delta_result_t decode(const uint8_t *frame, uint8_t size, int32_t *values);
+
+	/**
+	 * @brief Get the number of frames lost between the last two decoded frames.
+	 * @return Number of lost frames.
+	 */
+	uint8_t getLostFrames(void);
+
+private:
+	int32_t keyframe[LPP_DELTA_MAX_VALUES];  ///< Values of the last keyframe
+	uint8_t count;                           ///< Number of values in every frame
+	uint8_t keyframeId;                      ///< Id of the last keyframe
+	uint8_t counter;                         ///< Counter of the last frame
+	uint8_t lostFrames;                      ///< Frames lost before the last frame
+	bool hasKeyframe;                        ///< A keyframe was received
+	bool hasCounter;                         ///< A frame was received
+};
+
+/**
+ * @brief Write a signed value as zigzag varint.
+ * @param value Value to be written.
+ * @param buffer Buffer with at least LPP_DELTA_VARINT_MAX_SIZE bytes free.
+ * @return Number of bytes written.
+ */
+uint8_t lppWriteVarint(int32_t value, uint8_t *buffer);
+
+/**
+ * @brief Read a zigzag varint.
+ * @param buffer Buffer to read from.
+ * @param size Number of bytes available.
+ * @param value The decoded value.
+ * @return Number of bytes read, or 0 when the varint is truncated or too long.
+ */
+uint8_t lppReadVarint(const uint8_t *buffer, uint8_t size, int32_t *value);
+
+#endif
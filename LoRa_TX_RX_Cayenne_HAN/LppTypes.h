@@ -0,0 +1,316 @@
+/**
+ * @file  LppTypes.h
+ * @brief LPP data types: identifiers, sizes and encoder traits.
+ * @note  Generated by host/schema/lpp_schema.js from lpp_schema.json, do not edit.
+ *        Change host/schema/lpp_schema.json and run node host/schema/lpp_schema.js.
+ * @copyright (c) 2024, Leon Nguyen and Len Verploegen
+ *
+ * The MIT License (MIT), see CustomCayeneLPP.h.
+ *
+ * @author  Leon Nguyen and Len Verpleogen
+ */
+#ifndef _LPPTYPES_H_
+#define _LPPTYPES_H_
+
+#include <stdint.h>
+
+#define LPP_DIGITAL_INPUT 0          /// \ Identifier for digital input data type (1 Byte)
+#define LPP_DIGITAL_OUTPUT 1         /// \ Identifier for digital output data type (1 Byte)
+#define LPP_ANALOG_INPUT 2           /// \ Identifier for analog input data type (2 bytes and is scaled by a factor of 0.01 (signed)
+#define LPP_ANALOG_OUTPUT 3          /// \ Identifier for analog output data type (2 bytes and is scaled by a factor of 0.01 (signed))
+#define LPP_ADDBIT 4                 /// \ Identifier for additional bit data type (1 Byte)
+#define LPP_ADDBYTE 5                /// \ Identifier for additional byte data type (1 Byte)
+#define LPP_ADDWORD 6                /// \ Identifier for additional 2-byte data type (2 bytes)
+#define LPP_ADDDOUBLEWORD 7          /// \ Identifier for additional 4-byte data type (4 bytes)
+#define LPP_ADDFLOAT 8               /// \ Identifier for additional floating-point data type (4 bytes, 0.0000001 signed)
+#define LPP_CUSTOMBYTE 9             /// \ Identifier for custom data type
+#define LPP_TIMESERIES 10            /// \ Identifier for a series of samples of one sensor type (10 byte header, n samples)
+#define LPP_GENERIC_SENSOR 100       /// \ Identifier for generic sensor data type (4 bytes unsigned)
+#define LPP_LUMINOSITY 101           /// \ Identifier for luminosity data type (2 bytes, 1 lux unsigned)
+#define LPP_PRESENCE 102             /// \ Identifier for presence data type (1 byte, 1)
+#define LPP_TEMPERATURE 103          /// \ Identifier for temperature data type (2 bytes, 0.1°C signed)
+#define LPP_RELATIVE_HUMIDITY 104    /// \ Identifier for relative humidity data type (1 byte, 0.5% unsigned)
+#define LPP_ACCELEROMETER 113        /// \ Identifier for accelerometer data type (2 bytes per axis, 0.001G)
+#define LPP_BAROMETRIC_PRESSURE 115  /// \ Identifier for barometric pressure data type (2 bytes 0.1 hPa Unsigned)
+#define LPP_VOLTAGE 116              /// \ Identifier for voltage data type (2 bytes, 0.01 V unsigned)
+#define LPP_CURRENT 117              /// \ Identifier for current data type (2 bytes, 0.001 A unsigned)
+#define LPP_FREQUENCY 118            /// \ Identifier for frequency data type (4 bytes, 1 Hz unsigned)
+#define LPP_PERCENTAGE 120           /// \ Identifier for percentage data type (1 byte, 1% unsigned)
+#define LPP_ALTITUDE 121             /// \ Identifier for altitude data type (2 bytes, 1 m signed)
+#define LPP_CONCENTRATION 125        /// \ Identifier for concentration data type (2 bytes, 1 PPM unsigned)
+#define LPP_POWER 128                /// \ Identifier for power data type (2 bytes, 1 W unsigned)
+#define LPP_DISTANCE 130             /// \ Identifier for distance data type (4 bytes, 0.001 m unsigned)
+#define LPP_ENERGY 131               /// \ Identifier for energy data type (4 bytes, 0.001 kWh unsigned)
+#define LPP_DIRECTION 132            /// \ Identifier for direction data type (2 bytes, 1° unsigned)
+#define LPP_UNIXTIME 133             /// \ Identifier for time data type (4 bytes, Unix time unsigned)
+#define LPP_GYROMETER 134            /// \ Identifier for gyrometer data type (2 bytes per axis, 0.01 °/s)
+#define LPP_COLOUR 135               /// \ Identifier for colour data type (1 byte per colour, R, G and B)
+#define LPP_GPS 136                  /// \ Identifier for GPS data type (3 byte lon/lat 0.0001 °, 3 bytes alt 0.01 meter)
+#define LPP_SWITCH 142               /// \ Identifier for switch data type (1 byte, 0/1)
+
+// The total number of bytes required for the Data ID, Data Type, and Data Size
+#define LPP_DIGITAL_INPUT_SIZE 3
+#define LPP_DIGITAL_OUTPUT_SIZE 3
+#define LPP_ANALOG_INPUT_SIZE 4
+#define LPP_ANALOG_OUTPUT_SIZE 4
+#define LPP_ADDBIT_SIZE 3
+#define LPP_ADDBYTE_SIZE 3
+#define LPP_ADDWORD_SIZE 4
+#define LPP_ADDDOUBLEWORD_SIZE 6
+#define LPP_ADDFLOAT_SIZE 6
+#define LPP_TIMESERIES_SIZE 10       // Without the samples
+#define LPP_GENERIC_SENSOR_SIZE 6
+#define LPP_LUMINOSITY_SIZE 4
+#define LPP_PRESENCE_SIZE 3
+#define LPP_TEMPERATURE_SIZE 4
+#define LPP_RELATIVE_HUMIDITY_SIZE 3
+#define LPP_ACCELEROMETER_SIZE 8
+#define LPP_BAROMETRIC_PRESSURE_SIZE 4
+#define LPP_VOLTAGE_SIZE 4
+#define LPP_CURRENT_SIZE 4
+#define LPP_FREQUENCY_SIZE 6
+#define LPP_PERCENTAGE_SIZE 3
+#define LPP_ALTITUDE_SIZE 4
+#define LPP_CONCENTRATION_SIZE 4
+#define LPP_POWER_SIZE 4
+#define LPP_DISTANCE_SIZE 6
+#define LPP_ENERGY_SIZE 6
+#define LPP_DIRECTION_SIZE 4
+#define LPP_UNIXTIME_SIZE 6
+#define LPP_GYROMETER_SIZE 8
+#define LPP_COLOUR_SIZE 5
+#define LPP_GPS_SIZE 11
+#define LPP_SWITCH_SIZE 3
+
+/**
+ * @brief Encoding of an LPP data type, for the types with one resolution for all values.
+ * @tparam Type Data type identifier.
+ */
+template <uint8_t Type>
+struct LppType;
+
+template <>
+struct LppType<LPP_DIGITAL_INPUT> {
+	static const uint16_t resolution = 1;
+	static const uint8_t width = 1;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_DIGITAL_OUTPUT> {
+	static const uint16_t resolution = 1;
+	static const uint8_t width = 1;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_ANALOG_INPUT> {
+	static const uint16_t resolution = 100;
+	static const uint8_t width = 2;
+	static const uint8_t values = 1;
+	static const bool isSigned = true;
+};
+
+template <>
+struct LppType<LPP_ANALOG_OUTPUT> {
+	static const uint16_t resolution = 100;
+	static const uint8_t width = 2;
+	static const uint8_t values = 1;
+	static const bool isSigned = true;
+};
+
+template <>
+struct LppType<LPP_ADDBYTE> {
+	static const uint16_t resolution = 1;
+	static const uint8_t width = 1;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_ADDWORD> {
+	static const uint16_t resolution = 1;
+	static const uint8_t width = 2;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_ADDDOUBLEWORD> {
+	static const uint16_t resolution = 1;
+	static const uint8_t width = 4;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_GENERIC_SENSOR> {
+	static const uint16_t resolution = 1;
+	static const uint8_t width = 4;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_LUMINOSITY> {
+	static const uint16_t resolution = 1;
+	static const uint8_t width = 2;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_PRESENCE> {
+	static const uint16_t resolution = 1;
+	static const uint8_t width = 1;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_TEMPERATURE> {
+	static const uint16_t resolution = 10;
+	static const uint8_t width = 2;
+	static const uint8_t values = 1;
+	static const bool isSigned = true;
+};
+
+template <>
+struct LppType<LPP_RELATIVE_HUMIDITY> {
+	static const uint16_t resolution = 2;
+	static const uint8_t width = 1;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_ACCELEROMETER> {
+	static const uint16_t resolution = 1000;
+	static const uint8_t width = 2;
+	static const uint8_t values = 3;
+	static const bool isSigned = true;
+};
+
+template <>
+struct LppType<LPP_BAROMETRIC_PRESSURE> {
+	static const uint16_t resolution = 10;
+	static const uint8_t width = 2;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_VOLTAGE> {
+	static const uint16_t resolution = 100;
+	static const uint8_t width = 2;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_CURRENT> {
+	static const uint16_t resolution = 1000;
+	static const uint8_t width = 2;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_FREQUENCY> {
+	static const uint16_t resolution = 1;
+	static const uint8_t width = 4;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_PERCENTAGE> {
+	static const uint16_t resolution = 1;
+	static const uint8_t width = 1;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_ALTITUDE> {
+	static const uint16_t resolution = 1;
+	static const uint8_t width = 2;
+	static const uint8_t values = 1;
+	static const bool isSigned = true;
+};
+
+template <>
+struct LppType<LPP_CONCENTRATION> {
+	static const uint16_t resolution = 1;
+	static const uint8_t width = 2;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_POWER> {
+	static const uint16_t resolution = 1;
+	static const uint8_t width = 2;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_DISTANCE> {
+	static const uint16_t resolution = 1000;
+	static const uint8_t width = 4;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_ENERGY> {
+	static const uint16_t resolution = 1000;
+	static const uint8_t width = 4;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_DIRECTION> {
+	static const uint16_t resolution = 1;
+	static const uint8_t width = 2;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_UNIXTIME> {
+	static const uint16_t resolution = 1;
+	static const uint8_t width = 4;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_GYROMETER> {
+	static const uint16_t resolution = 100;
+	static const uint8_t width = 2;
+	static const uint8_t values = 3;
+	static const bool isSigned = true;
+};
+
+template <>
+struct LppType<LPP_COLOUR> {
+	static const uint16_t resolution = 1;
+	static const uint8_t width = 1;
+	static const uint8_t values = 3;
+	static const bool isSigned = false;
+};
+
+template <>
+struct LppType<LPP_SWITCH> {
+	static const uint16_t resolution = 1;
+	static const uint8_t width = 1;
+	static const uint8_t values = 1;
+	static const bool isSigned = false;
+};
+
+#endif
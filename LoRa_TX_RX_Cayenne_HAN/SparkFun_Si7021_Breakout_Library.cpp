@@ -108,6 +108,25 @@ float Weather::getTempF()
   return((getTemp() * 1.8) + 32.0); // Convert celsius to fahrenheit
 }
 
+//Integer versions in hundredths of a %RH or degree, these do not need the float library
+int16_t Weather::getRHCenti()
+{
+	uint16_t RH_Code = makeMeasurment(HUMD_MEASURE_NOHOLD);
+	return (int16_t)((12500UL*RH_Code) >> 16) - 600;
+}
+
+int16_t Weather::readTempCenti()
+{
+	uint16_t temp_Code = makeMeasurment(TEMP_PREV);
+	return (int16_t)((17525UL*temp_Code) >> 16) - 4685;
+}
+
+int16_t Weather::getTempCenti()
+{
+	uint16_t temp_Code = makeMeasurment(TEMP_MEASURE_NOHOLD);
+	return (int16_t)((17525UL*temp_Code) >> 16) - 4685;
+}
+
 
 void Weather::heaterOn()
 {
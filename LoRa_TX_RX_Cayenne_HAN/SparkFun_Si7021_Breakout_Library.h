@@ -74,6 +74,9 @@ public:
 	float getTemp();
 	float readTempF();
 	float getTempF();
+	int16_t getRHCenti();
+	int16_t readTempCenti();
+	int16_t getTempCenti();
 	void  heaterOn();
 	void  heaterOff();
 	void  changeResolution(uint8_t i);
@@ -17,6 +17,8 @@
 #define TTN_HEX_CHAR_TO_NIBBLE(c) ((c >= 'A') ? (c - 'A' + 0x0A) : (c - '0'))
 #define TTN_HEX_PAIR_TO_BYTE(h, l) ((TTN_HEX_CHAR_TO_NIBBLE(h) << 4) + TTN_HEX_CHAR_TO_NIBBLE(l))
 
+const char hex_digits[] PROGMEM = "0123456789ABCDEF";
+
 const char ok[] PROGMEM = "ok";
 const char on[] PROGMEM = "on";
 const char off[] PROGMEM = "off";
@@ -29,21 +31,6 @@ const char rn2483a[] PROGMEM = "RN2483A";
 const char rn2903[] PROGMEM = "RN2903";
 const char rn2903as[] PROGMEM = "RN2903AS";
 
-const char *const compare_table[] PROGMEM = {ok, on, off, accepted, mac_tx_ok, mac_rx, mac_err, rn2483, rn2483a, rn2903, rn2903as};
-
-#define CMP_OK 0
-#define CMP_ON 1
-#define CMP_OFF 2
-#define CMP_ACCEPTED 3
-#define CMP_MAC_TX_OK 4
-#define CMP_MAC_RX 5
-#define CMP_MAC_ERR 6
-#define CMP_RN2483 7
-#define CMP_RN2483A 8
-#define CMP_RN2903 9
-#define CMP_RN2903AS 10
-
-// CMP OK
 const char busy[] PROGMEM = "busy";
 const char fram_counter_err_rejoin_needed[] PROGMEM = "fram_counter_err_rejoin_needed";
 const char invalid_class[] PROGMEM = "invalid_class";
@@ -57,23 +44,9 @@ const char not_joined[] PROGMEM = "not_joined";
 const char silent[] PROGMEM = "silent";
 const char err[] PROGMEM = "err";
 
-const char *const compareerr_table[] PROGMEM = {ok, busy, fram_counter_err_rejoin_needed, invalid_class, invalid_data_len, invalid_param, keys_not_init, mac_paused, multicast_keys_not_set, no_free_ch, not_joined, silent, err};
-
-#define CMP_ERR_OK 0
-#define CMP_ERR_BUSY 1
-#define CMP_ERR_FRMCNT 2
-#define CMP_ERR_INVCLS 3
-#define CMP_ERR_INVDLEN 4
-#define CMP_ERR_INVPAR 5
-#define CMP_ERR_NKEYINT 6
-#define CMP_ERR_MACPAUSE 7
-#define CMP_ERR_NKYMLTCST 8
-#define CMP_ERR_NFRCHN 9
-#define CMP_ERR_NJOIN 10
-#define CMP_ERR_SILENT 11
-#define CMP_ERR_ERR 12
-
-#define CMP_ERR_LAST CMP_ERR_ERR
+// Every response in the order of ttn_modem_response_t
+const char *const response_table[] PROGMEM = {ok, busy, fram_counter_err_rejoin_needed, invalid_class, invalid_data_len, invalid_param, keys_not_init, mac_paused, multicast_keys_not_set, no_free_ch, not_joined, silent, err,
+			on, off, accepted, mac_tx_ok, mac_rx, mac_err, rn2483, rn2483a, rn2903, rn2903as};
 
 #define SENDING "Sending: "
 #define SEND_MSG "\r\n"
@@ -116,8 +89,9 @@ const char error_key_length[] PROGMEM = "One or more keys are of invalid length.
 const char check_configuration[] PROGMEM = "Check your coverage, keys and backend status.";
 const char no_response[] PROGMEM =  "No response from RN module.";
 const char invalid_module[] PROGMEM = "Invalid module (must be RN2xx3[xx]).";
+const char send_busy[] PROGMEM = "Uplink of beginSend() in progress, call service() until it is done.";
 
-const char *const error_msg[] PROGMEM = {invalid_sf, invalid_fp, unexpected_response, send_command_failed, join_failed, join_not_accepted, personalize_not_accepted, response_is_not_ok, error_key_length, check_configuration, no_response, invalid_module};
+const char *const error_msg[] PROGMEM = {invalid_sf, invalid_fp, unexpected_response, send_command_failed, join_failed, join_not_accepted, personalize_not_accepted, response_is_not_ok, error_key_length, check_configuration, no_response, invalid_module, send_busy};
 
 #define ERR_INVALID_SF 0
 #define ERR_INVALID_FP 1
@@ -131,6 +105,7 @@ const char *const error_msg[] PROGMEM = {invalid_sf, invalid_fp, unexpected_resp
 #define ERR_CHECK_CONFIGURATION 9
 #define ERR_NO_RESPONSE 10
 #define ERR_INVALID_MODULE 11
+#define ERR_SEND_BUSY 12
 
 const char personalize_accepted[] PROGMEM = "Personalize accepted. Status: ";
 const char join_accepted[] PROGMEM = "Join accepted. Status: ";
@@ -311,6 +286,33 @@ const char *const mac_tx_table[] PROGMEM = {mac_tx_type_cnf, mac_tx_type_ucnf};
 #define MAC_TX_TYPE_CNF 0
 #define MAC_TX_TYPE_UCNF 1
 
+// Commands and prefixes that are always sent together, streamed from flash in one piece
+const char mac_set_prefix[] PROGMEM = "mac set ";
+const char mac_get_prefix[] PROGMEM = "mac get ";
+const char sys_get_prefix[] PROGMEM = "sys get ";
+const char radio_get_prefix[] PROGMEM = "radio get ";
+const char mac_get_ch_status_prefix[] PROGMEM = "mac get ch status ";
+const char sys_get_ver_command[] PROGMEM = "sys get ver";
+const char sys_sleep_prefix[] PROGMEM = "sys sleep ";
+const char mac_save_command[] PROGMEM = "mac save";
+
+const char mac_set_ch_dcycle_prefix[] PROGMEM = "mac set ch dcycle ";
+const char mac_set_ch_drrange_prefix[] PROGMEM = "mac set ch drrange ";
+const char mac_set_ch_freq_prefix[] PROGMEM = "mac set ch freq ";
+const char mac_set_ch_status_prefix[] PROGMEM = "mac set ch status ";
+
+const char *const mac_set_ch_prefixes[] PROGMEM = {mac_set_ch_dcycle_prefix, mac_set_ch_drrange_prefix, mac_set_ch_freq_prefix, mac_set_ch_status_prefix}; // MAC_CHANNEL_* order
+
+const char mac_join_otaa_command[] PROGMEM = "mac join otaa";
+const char mac_join_abp_command[] PROGMEM = "mac join abp";
+
+const char *const mac_join_commands[] PROGMEM = {mac_join_otaa_command, mac_join_abp_command}; // MAC_JOIN_MODE_* order
+
+const char mac_tx_cnf_prefix[] PROGMEM = "mac tx cnf ";
+const char mac_tx_ucnf_prefix[] PROGMEM = "mac tx uncnf ";
+
+const char *const mac_tx_prefixes[] PROGMEM = {mac_tx_cnf_prefix, mac_tx_ucnf_prefix}; // MAC_TX_TYPE_* order
+
 #define MAC_TABLE 0
 #define MAC_GET_SET_TABLE 1
 #define MAC_JOIN_TABLE 2
@@ -320,28 +322,6 @@ const char *const mac_tx_table[] PROGMEM = {mac_tx_type_cnf, mac_tx_type_ucnf};
 #define RADIO_TABLE 6
 #define ERR_MESSAGE 7
 #define SUCCESS_MESSAGE 8
-#define CMP_TABLE 9
-#define CMP_ERR_TABLE 10
-
-int pgmstrcmp(const char *str1, uint8_t str2Index, uint8_t table = CMP_TABLE)
-{
-  if (0 == strlen(str1))
-	  return -1;
-
-  char str2[128];
-
-  switch (table) {
-  case CMP_ERR_TABLE:
-    strcpy_P(str2, (char *)pgm_read_word(&(compareerr_table[str2Index])));
-    break;
-
-  default:
-  case CMP_TABLE:
-    strcpy_P(str2, (char *)pgm_read_word(&(compare_table[str2Index])));
-  }
-
-  return memcmp(str1, str2, min(strlen(str1), strlen(str2)));
-}
 
 uint8_t digits(uint8_t port)
 {
@@ -356,19 +336,6 @@ uint8_t digits(uint8_t port)
   return 1;
 }
 
-uint8_t receivedPort(const char *s)
-{
-  uint8_t port = 0;
-  uint8_t i = 0;
-  while (s[i] != ' ' && s[i] != '\0')
-  {
-    port *= 10;
-    port += s[i] - 48;
-    i++;
-  }
-  return port;
-}
-
 TheThingsNetwork::TheThingsNetwork(Stream &modemStream, Stream &debugStream, ttn_fp_t fp, uint8_t sf, uint8_t fsb)
 {
   this->debugStream = &debugStream;
@@ -506,6 +473,10 @@ int8_t TheThingsNetwork::getPowerIndex()
 
 bool TheThingsNetwork::getChannelStatus (uint8_t channel)
 {
+  if (sendBusy())
+  {
+    return false;
+  }
   char str[5];
   if (channel > 9)
   {
@@ -518,29 +489,83 @@ bool TheThingsNetwork::getChannelStatus (uint8_t channel)
 	str[0] = channel + 48;
 	str[1] = '\0';
   }
-  sendCommand(MAC_TABLE, MAC_PREFIX, true, false);
-  sendCommand(MAC_TABLE, MAC_GET, true, false); // default "get " in between (same as radio get)
-  sendCommand(MAC_GET_SET_TABLE, MAC_CH, true, false);
-  sendCommand(MAC_CH_TABLE, MAC_CHANNEL_STATUS, true, false);
+  writeCommand(mac_get_ch_status_prefix, false);
   modemStream->write(str);
   modemStream->write(SEND_MSG);
 
   if (readLine(buffer, sizeof(buffer)))
-	  return (pgmstrcmp(buffer, CMP_ON) == 0); // true if on, false if off or an error occurs
+	  return (classifyResponse(buffer) == TTN_RESPONSE_ON); // true if on, false if off or an error occurs
   else
 	  return false; // error
 }
 
 ttn_response_code_t TheThingsNetwork::getLastError(){
 
-	int match, pos;
-	for (pos=0; pos <= CMP_ERR_LAST; pos++){
-		match = pgmstrcmp(buffer, pos, CMP_ERR_TABLE);
-		if (match == 0)
-			break;
-	}
+	ttn_modem_response_t response = classifyResponse(buffer);
+	if (response < TTN_RESPONSE_OK || response > TTN_RESPONSE_ERR)
+		response = (ttn_modem_response_t)(TTN_RESPONSE_ERR + 1); // no error response
 
-	return (ttn_response_code_t)(-1* pos); // code order is equal
+	return (ttn_response_code_t)(-1* response); // code order is equal
+}
+
+ttn_modem_response_t TheThingsNetwork::classifyResponse(const char *response)
+{
+  // Length of the first word, it leaves one candidate together with a letter at most
+  size_t length = 0;
+  while (response[length] != '\0' && response[length] != ' ' && response[length] != '\r')
+  {
+    length++;
+  }
+
+  ttn_modem_response_t candidate;
+  switch (length)
+  {
+  case 2:
+    candidate = response[1] == 'k' ? TTN_RESPONSE_OK : TTN_RESPONSE_ON;
+    break;
+  case 3:
+    candidate = response[0] == 'o' ? TTN_RESPONSE_OFF : TTN_RESPONSE_ERR;
+    break;
+  case 4:
+    candidate = TTN_RESPONSE_BUSY;
+    break;
+  case 6:
+    candidate = response[0] == 'm' ? TTN_RESPONSE_MAC_RX : response[0] == 's' ? TTN_RESPONSE_SILENT : response[3] == '4' ? TTN_RESPONSE_RN2483 : TTN_RESPONSE_RN2903;
+    break;
+  case 7:
+    candidate = response[0] == 'm' ? TTN_RESPONSE_MAC_ERR : TTN_RESPONSE_RN2483A;
+    break;
+  case 8:
+    candidate = response[0] == 'a' ? TTN_RESPONSE_ACCEPTED : TTN_RESPONSE_RN2903AS;
+    break;
+  case 9:
+    candidate = TTN_RESPONSE_MAC_TX_OK;
+    break;
+  case 10:
+    candidate = response[0] == 'm' ? TTN_RESPONSE_MAC_PAUSED : response[2] == '_' ? TTN_RESPONSE_NO_FREE_CH : TTN_RESPONSE_NOT_JOINED;
+    break;
+  case 13:
+    candidate = response[0] == 'k' ? TTN_RESPONSE_KEYS_NOT_INIT : response[8] == 'c' ? TTN_RESPONSE_INVALID_CLASS : TTN_RESPONSE_INVALID_PARAM;
+    break;
+  case 16:
+    candidate = TTN_RESPONSE_INVALID_DATA_LEN;
+    break;
+  case 22:
+    candidate = TTN_RESPONSE_MULTICAST_KEYS_NOT_SET;
+    break;
+  case 30:
+    candidate = TTN_RESPONSE_FRAME_COUNTER_ERR;
+    break;
+  default:
+    return TTN_RESPONSE_UNKNOWN;
+  }
+
+  // The candidate has the same length, one compare straight from flash confirms the word
+  if (memcmp_P(response, (char *)pgm_read_word(&(response_table[candidate])), length) != 0)
+  {
+    return TTN_RESPONSE_UNKNOWN;
+  }
+  return candidate;
 }
 
 void TheThingsNetwork::debugPrintIndex(uint8_t index, const char *value)
@@ -579,6 +604,7 @@ void TheThingsNetwork::debugPrintMessage(uint8_t type, uint8_t index, const char
 
 void TheThingsNetwork::clearReadBuffer()
 {
+  received = 0; // A partial Class C line of service() goes with the rest of the modem input
   while (modemStream->available())
   {
     modemStream->read();
@@ -604,6 +630,10 @@ size_t TheThingsNetwork::readLine(char *buffer, size_t size, uint8_t attempts)
 
 size_t TheThingsNetwork::readResponse(uint8_t prefixTable, uint8_t index, char *buffer, size_t size)
 {
+  if (sendBusy())
+  {
+    return 0;
+  }
   clearReadBuffer();
   sendCommand(prefixTable, 0, true, false);
   sendCommand(prefixTable, index, false, false);
@@ -613,9 +643,22 @@ size_t TheThingsNetwork::readResponse(uint8_t prefixTable, uint8_t index, char *
 
 size_t TheThingsNetwork::readResponse(uint8_t prefixTable, uint8_t indexTable, uint8_t index, char *buffer, size_t size)
 {
+  if (sendBusy())
+  {
+    return 0;
+  }
   clearReadBuffer();
-  sendCommand(prefixTable, 0, true, false);
-  sendCommand(MAC_TABLE, MAC_GET, true, false);
+  switch (prefixTable)
+  {
+  case SYS_TABLE:
+    writeCommand(sys_get_prefix, false);
+    break;
+  case RADIO_TABLE:
+    writeCommand(radio_get_prefix, false);
+    break;
+  default:
+    writeCommand(mac_get_prefix, false);
+  }
   sendCommand(indexTable, index, false, false);
   modemStream->write(SEND_MSG);
   return readLine(buffer, size);
@@ -633,9 +676,7 @@ void TheThingsNetwork::autoBaud()
     modemStream->write((byte)0x00);
     modemStream->write(0x55);
     modemStream->write(SEND_MSG);
-    sendCommand(SYS_TABLE, 0, true, false);
-    sendCommand(SYS_TABLE, SYS_GET, true, false);
-    sendCommand(SYS_TABLE, SYS_GET_VER, false, false);
+    writeCommand(sys_get_ver_command, false);
     modemStream->write(SEND_MSG);
     length = modemStream->readBytesUntil('\n', buffer, sizeof(buffer));
   }
@@ -647,6 +688,10 @@ void TheThingsNetwork::autoBaud()
 
 void TheThingsNetwork::reset(bool adr)
 {
+  if (sendBusy())
+  {
+    return;
+  }
   // autobaud and send "sys reset"
   autoBaud();
   readResponse(SYS_TABLE, SYS_RESET, buffer, sizeof(buffer));
@@ -676,9 +721,12 @@ void TheThingsNetwork::resetHard(uint8_t resetPin){
 
 void TheThingsNetwork::saveState()
 {
+  if (sendBusy())
+  {
+    return;
+  }
   debugPrint(SENDING);
-  sendCommand(MAC_TABLE, MAC_PREFIX, true);
-  sendCommand(MAC_TABLE, MAC_SAVE, false);
+  writeCommand(mac_save_command);
   modemStream->write(SEND_MSG);
   debugPrintLn();
   waitForOk();
@@ -691,6 +739,10 @@ void TheThingsNetwork::onMessage(void (*cb)(const uint8_t *payload, size_t size,
 
 bool TheThingsNetwork::personalize(const char *devAddr, const char *nwkSKey, const char *appSKey, bool resetFirst)
 {
+  if (sendBusy())
+  {
+    return false;
+  }
   if(resetFirst) {
     reset(adr);
   }
@@ -707,11 +759,15 @@ bool TheThingsNetwork::personalize(const char *devAddr, const char *nwkSKey, con
 
 bool TheThingsNetwork::personalize()
 {
+  if (sendBusy())
+  {
+    return false;
+  }
   configureChannels(fsb);
   setSF(sf);
   sendJoinSet(MAC_JOIN_MODE_ABP);
   readLine(buffer, sizeof(buffer));
-  if (pgmstrcmp(buffer, CMP_ACCEPTED) != 0)
+  if (classifyResponse(buffer) != TTN_RESPONSE_ACCEPTED)
   {
     debugPrintMessage(ERR_MESSAGE, ERR_PERSONALIZE_NOT_ACCEPTED, buffer);
     debugPrintMessage(ERR_MESSAGE, ERR_CHECK_CONFIGURATION);
@@ -725,6 +781,10 @@ bool TheThingsNetwork::personalize()
 
 bool TheThingsNetwork::provision(const char *appEui, const char *appKey, bool resetFirst)
 {
+  if (sendBusy())
+  {
+    return false;
+  }
   if(resetFirst) {
     reset(adr);
   }
@@ -743,6 +803,10 @@ bool TheThingsNetwork::provision(const char *appEui, const char *appKey, bool re
 
 bool TheThingsNetwork::join(int8_t retries, uint32_t retryDelay)
 {
+  if (sendBusy())
+  {
+    return false;
+  }
   int8_t attempts = 0;
   configureChannels(fsb);
   setSF(sf);
@@ -756,7 +820,7 @@ bool TheThingsNetwork::join(int8_t retries, uint32_t retryDelay)
       continue;
     }
     readLine(buffer, sizeof(buffer));
-    if (pgmstrcmp(buffer, CMP_ACCEPTED) != 0)
+    if (classifyResponse(buffer) != TTN_RESPONSE_ACCEPTED)
     {
       debugPrintMessage(ERR_MESSAGE, ERR_JOIN_NOT_ACCEPTED, buffer);
       debugPrintMessage(ERR_MESSAGE, ERR_CHECK_CONFIGURATION);
@@ -808,19 +872,29 @@ ttn_response_t TheThingsNetwork::parseBytes(){
     if (buffer[0]=='\0')
   	  return TTN_UNSUCCESSFUL_RECEIVE;
 
-	if (pgmstrcmp(buffer, CMP_MAC_RX) == 0)
+	if (classifyResponse(buffer) == TTN_RESPONSE_MAC_RX)
     {
-		port_t downlinkPort = receivedPort(buffer + 7);
-		char *data = buffer + 7 + digits(downlinkPort) + 1;
-		size_t downlinkLength = strlen(data) / 2;
-		if (downlinkLength > 0)
+		// "mac_rx <port> <hex>"
+		char *data = buffer + 7;
+		port_t downlinkPort = 0;
+		while (*data >= '0' && *data <= '9')
+		{
+		  downlinkPort = downlinkPort * 10 + (*data++ - '0');
+		}
+		if (*data == ' ')
+		{
+		  data++;
+		}
+		if (data[0] != '\0' && data[1] != '\0')
 		{
-		  uint8_t downlink[downlinkLength];
-		  for (size_t i = 0, d = 0; i < downlinkLength; i++, d += 2)
+		  debugPrintMessage(SUCCESS_MESSAGE, SCS_SUCCESSFUL_TRANSMISSION_RECEIVED, data);
+		  // Decode in place: byte i is written over hex digit i, after digits 2i and 2i+1 were read
+		  uint8_t *downlink = (uint8_t *)data;
+		  size_t downlinkLength = 0;
+		  for (const char *hex = data; hex[0] != '\0' && hex[1] != '\0'; hex += 2)
 		  {
-			downlink[i] = TTN_HEX_PAIR_TO_BYTE(data[d], data[d + 1]);
+			downlink[downlinkLength++] = TTN_HEX_PAIR_TO_BYTE(hex[0], hex[1]);
 		  }
-		  debugPrintMessage(SUCCESS_MESSAGE, SCS_SUCCESSFUL_TRANSMISSION_RECEIVED, data);
 		  if (messageCallback)
 		  {
 			messageCallback(downlink, downlinkLength, downlinkPort);
@@ -839,6 +913,10 @@ ttn_response_t TheThingsNetwork::parseBytes(){
 
 ttn_response_t TheThingsNetwork::sendBytes(const uint8_t *payload, size_t length, port_t port, bool confirm, uint8_t sf)
 {
+  if (sendBusy())
+  {
+    return TTN_ERROR_SEND_COMMAND_FAILED;
+  }
   if (sf != 0)
   {
     setSF(sf);
@@ -857,12 +935,13 @@ ttn_response_t TheThingsNetwork::sendBytes(const uint8_t *payload, size_t length
 	  return TTN_UNSUCCESSFUL_RECEIVE;
 
   // TX only?
-  if (pgmstrcmp(buffer, CMP_MAC_TX_OK) == 0)
+  ttn_modem_response_t response = classifyResponse(buffer);
+  if (response == TTN_RESPONSE_MAC_TX_OK)
   {
     debugPrintMessage(SUCCESS_MESSAGE, SCS_SUCCESSFUL_TRANSMISSION);
     return TTN_SUCCESSFUL_TRANSMISSION;
   }
-  else if (pgmstrcmp(buffer, CMP_MAC_ERR) == 0)
+  else if (response == TTN_RESPONSE_MAC_ERR)
 	return TTN_UNSUCCESSFUL_RECEIVE;
 
   // Received downlink message?
@@ -871,6 +950,10 @@ ttn_response_t TheThingsNetwork::sendBytes(const uint8_t *payload, size_t length
 
 ttn_response_t TheThingsNetwork::poll(port_t port, bool confirm, bool modem_only)
 {
+  if (sendBusy())
+  {
+    return TTN_ERROR_SEND_COMMAND_FAILED;
+  }
   switch(lw_class)
   {
 
@@ -888,12 +971,13 @@ ttn_response_t TheThingsNetwork::poll(port_t port, bool confirm, bool modem_only
 			  return TTN_UNSUCCESSFUL_RECEIVE;
 
 		  // Here we can have the result of pending TX, or pending RX (for confirmed messages)
-		  if (pgmstrcmp(buffer, CMP_MAC_TX_OK) == 0)
+		  ttn_modem_response_t response = classifyResponse(buffer);
+		  if (response == TTN_RESPONSE_MAC_TX_OK)
 		  {
 		    debugPrintMessage(SUCCESS_MESSAGE, SCS_SUCCESSFUL_TRANSMISSION);
 		    return TTN_SUCCESSFUL_TRANSMISSION;
 		  }
-		  else if (pgmstrcmp(buffer, CMP_MAC_ERR) == 0)
+		  else if (response == TTN_RESPONSE_MAC_ERR)
 			return TTN_UNSUCCESSFUL_RECEIVE;
 
 		  // Receive Message
@@ -921,8 +1005,136 @@ ttn_response_t TheThingsNetwork::poll(port_t port, bool confirm, bool modem_only
   }
 }
 
+bool TheThingsNetwork::beginSend(const uint8_t *payload, size_t length, port_t port, bool confirm)
+{
+  if (sendState != TTN_SEND_IDLE)
+  {
+    return false;
+  }
+
+  uint8_t mode = confirm ? MAC_TX_TYPE_CNF : MAC_TX_TYPE_UCNF;
+  if (!writePayload(mode, port, payload, length))
+  {
+    debugPrintMessage(ERR_MESSAGE, ERR_SEND_COMMAND_FAILED);
+    return false;
+  }
+
+  // The responses are collected by service() from here on
+  sendState = TTN_SEND_WAIT_OK;
+  sendStart = millis();
+  received = 0;
+  return true;
+}
+
+bool TheThingsNetwork::service()
+{
+  // Class C downlinks can arrive at any time, Class A only has responses during an uplink
+  bool listen = sendState != TTN_SEND_IDLE || lw_class == CLASS_C;
+
+  while (listen && modemStream->available())
+  {
+    char c = modemStream->read();
+    if (c != '\n')
+    {
+      if (received < sizeof(buffer) - 1)
+      {
+        buffer[received++] = c;
+      }
+      continue;
+    }
+    if (received > 0 && buffer[received - 1] == '\r')
+    {
+      received--;
+    }
+    buffer[received] = '\0';
+    if (received > 0)
+    {
+      received = 0;
+      serviceLine();
+    }
+  }
+
+  if (sendState != TTN_SEND_IDLE && millis() - sendStart > TTN_SEND_TIMEOUT)
+  {
+    this->needsHardReset = true; // Inform the application about the radio module is not responsive.
+    debugPrintMessage(ERR_MESSAGE, ERR_NO_RESPONSE);
+    finishSend(sendState == TTN_SEND_WAIT_OK ? TTN_ERROR_SEND_COMMAND_FAILED : TTN_UNSUCCESSFUL_RECEIVE);
+  }
+  return sendState != TTN_SEND_IDLE;
+}
+
+void TheThingsNetwork::serviceLine()
+{
+  switch (sendState)
+  {
+  case TTN_SEND_WAIT_OK:
+    // Response to the command, the RN2483 transmits after "ok"
+    if (classifyResponse(buffer) != TTN_RESPONSE_OK)
+    {
+      debugPrintMessage(ERR_MESSAGE, ERR_RESPONSE_IS_NOT_OK, buffer);
+      debugPrintMessage(ERR_MESSAGE, ERR_SEND_COMMAND_FAILED);
+      finishSend(TTN_ERROR_SEND_COMMAND_FAILED);
+      return;
+    }
+    sendState = TTN_SEND_WAIT_RESULT;
+    sendStart = millis();
+    return;
+
+  case TTN_SEND_WAIT_RESULT:
+    // Result after the RX windows, as sendBytes() handles it
+    switch (classifyResponse(buffer))
+    {
+    case TTN_RESPONSE_MAC_TX_OK:
+      debugPrintMessage(SUCCESS_MESSAGE, SCS_SUCCESSFUL_TRANSMISSION);
+      finishSend(TTN_SUCCESSFUL_TRANSMISSION);
+      break;
+    case TTN_RESPONSE_MAC_ERR:
+      finishSend(TTN_UNSUCCESSFUL_RECEIVE);
+      break;
+    default:
+      finishSend(parseBytes());
+    }
+    return;
+
+  default:
+  case TTN_SEND_IDLE:
+    // Class C downlink between uplinks
+    parseBytes();
+    return;
+  }
+}
+
+void TheThingsNetwork::finishSend(ttn_response_t response)
+{
+  sendState = TTN_SEND_IDLE;
+  if (sendCallback)
+  {
+    sendCallback(response);
+  }
+}
+
+void TheThingsNetwork::onSendComplete(void (*cb)(ttn_response_t response))
+{
+  sendCallback = cb;
+}
+
+bool TheThingsNetwork::sendBusy()
+{
+  // buffer and the modem belong to the uplink of beginSend() until service() finished it
+  if (sendState == TTN_SEND_IDLE)
+  {
+    return false;
+  }
+  debugPrintMessage(ERR_MESSAGE, ERR_SEND_BUSY);
+  return true;
+}
+
 void TheThingsNetwork::showStatus()
 {
+  if (sendBusy())
+  {
+    return;
+  }
   readResponse(SYS_TABLE, SYS_TABLE, SYS_GET_HWEUI, buffer, sizeof(buffer));
   debugPrintIndex(SHOW_EUI, buffer);
   readResponse(SYS_TABLE, SYS_TABLE, SYS_GET_VDD, buffer, sizeof(buffer));
@@ -941,6 +1153,10 @@ void TheThingsNetwork::showStatus()
 
 bool TheThingsNetwork::checkValidModuleConnected(bool autoBaudFirst)
 {
+  if (sendBusy())
+  {
+    return false;
+  }
   // check if we want to autobaud first
   if(autoBaudFirst)
   {
@@ -958,7 +1174,8 @@ bool TheThingsNetwork::checkValidModuleConnected(bool autoBaudFirst)
   char *model = strtok(buffer, " ");
   debugPrintIndex(SHOW_MODEL, model);
   // check if module is valid (must be RN2483, RN2483A, RN2903 or RN2903AS)
-  if(pgmstrcmp(model, CMP_RN2483) == 0 || pgmstrcmp(model, CMP_RN2483A) == 0 || pgmstrcmp(model, CMP_RN2903) == 0 || pgmstrcmp(model, CMP_RN2903AS) == 0)
+  ttn_modem_response_t response = model ? classifyResponse(model) : TTN_RESPONSE_UNKNOWN;
+  if(response >= TTN_RESPONSE_RN2483 && response <= TTN_RESPONSE_RN2903AS)
   {
     debugPrintMessage(SUCCESS_MESSAGE, SCS_VALID_MODULE);
     return true;                                                // module responded and is valid (recognized/supported)
@@ -1314,45 +1531,67 @@ bool TheThingsNetwork::setFCD(uint32_t fcd){
 
 void TheThingsNetwork::sendCommand(uint8_t table, uint8_t index, bool appendSpace, bool print)
 {
-  char command[100];
+  const char *const *commands;
   switch (table)
   {
   case MAC_TABLE:
-    strcpy_P(command, (char *)pgm_read_word(&(mac_table[index])));
+    commands = mac_table;
     break;
   case MAC_GET_SET_TABLE:
-    strcpy_P(command, (char *)pgm_read_word(&(mac_options[index])));
+    commands = mac_options;
     break;
   case MAC_JOIN_TABLE:
-    strcpy_P(command, (char *)pgm_read_word(&(mac_join_mode[index])));
+    commands = mac_join_mode;
     break;
   case MAC_CH_TABLE:
-    strcpy_P(command, (char *)pgm_read_word(&(mac_ch_options[index])));
+    commands = mac_ch_options;
     break;
   case MAC_TX_TABLE:
-    strcpy_P(command, (char *)pgm_read_word(&(mac_tx_table[index])));
+    commands = mac_tx_table;
     break;
   case SYS_TABLE:
-    strcpy_P(command, (char *)pgm_read_word(&(sys_table[index])));
+    commands = sys_table;
     break;
   case RADIO_TABLE:
-    strcpy_P(command, (char *)pgm_read_word(&(radio_table[index])));
+    commands = radio_table;
     break;
   default:
     return;
   }
-  modemStream->write(command);
+  writeCommand((char *)pgm_read_word(&(commands[index])), print);
   if (appendSpace)
   {
-    modemStream->write(" ");
+    modemStream->write(' ');
   }
   if (print)
   {
-    debugPrint(command);
     debugPrint(F(" "));
   }
 }
 
+void TheThingsNetwork::writeCommand(const char *command, bool print)
+{
+  // Stream the command from flash in pieces, instead of copying all of it to RAM first
+  char chunk[16];
+  size_t length;
+  do
+  {
+    for (length = 0; length < sizeof(chunk) && (chunk[length] = pgm_read_byte(command + length)) != '\0'; length++)
+    {
+    }
+    if (length == 0)
+    {
+      break;
+    }
+    command += length;
+    modemStream->write(chunk, length);
+    if (print && debugStream)
+    {
+      debugStream->write(chunk, length);
+    }
+  } while (length == sizeof(chunk));
+}
+
 bool TheThingsNetwork::sendMacSet(uint8_t index, uint8_t value1, unsigned long value2)
 {
 	char buf[15];
@@ -1362,10 +1601,13 @@ bool TheThingsNetwork::sendMacSet(uint8_t index, uint8_t value1, unsigned long v
 
 bool TheThingsNetwork::sendMacSet(uint8_t index, const char *value)
 {
+  if (sendBusy())
+  {
+    return false;
+  }
   clearReadBuffer();
   debugPrint(SENDING);
-  sendCommand(MAC_TABLE, MAC_PREFIX, true);
-  sendCommand(MAC_TABLE, MAC_SET, true);
+  writeCommand(mac_set_prefix);
   sendCommand(MAC_GET_SET_TABLE, index, true);
   modemStream->write(value);
   modemStream->write(SEND_MSG);
@@ -1375,8 +1617,12 @@ bool TheThingsNetwork::sendMacSet(uint8_t index, const char *value)
 
 bool TheThingsNetwork::waitForOk()
 {
+  if (sendBusy())
+  {
+    return false;
+  }
   readLine(buffer, sizeof(buffer));
-  if (pgmstrcmp(buffer, CMP_OK) != 0)
+  if (classifyResponse(buffer) != TTN_RESPONSE_OK)
   {
     debugPrintMessage(ERR_MESSAGE, ERR_RESPONSE_IS_NOT_OK, buffer);
     return false;
@@ -1393,6 +1639,10 @@ bool TheThingsNetwork::sendChSet(uint8_t index, uint8_t channel, unsigned long v
 
 bool TheThingsNetwork::sendChSet(uint8_t index, uint8_t channel, const char *value)
 {
+  if (sendBusy())
+  {
+    return false;
+  }
   clearReadBuffer();
   char ch[5];
   if (channel > 9)
@@ -1407,10 +1657,7 @@ bool TheThingsNetwork::sendChSet(uint8_t index, uint8_t channel, const char *val
     ch[1] = '\0';
   }
   debugPrint(F(SENDING));
-  sendCommand(MAC_TABLE, MAC_PREFIX, true);
-  sendCommand(MAC_TABLE, MAC_SET, true);
-  sendCommand(MAC_GET_SET_TABLE, MAC_CH, true);
-  sendCommand(MAC_CH_TABLE, index, true);
+  writeCommand((char *)pgm_read_word(&(mac_set_ch_prefixes[index])));
   modemStream->write(ch);
   modemStream->write(" ");
   modemStream->write(value);
@@ -1423,11 +1670,13 @@ bool TheThingsNetwork::sendChSet(uint8_t index, uint8_t channel, const char *val
 
 bool TheThingsNetwork::sendJoinSet(uint8_t type)
 {
+  if (sendBusy())
+  {
+    return false;
+  }
   clearReadBuffer();
   debugPrint(F(SENDING));
-  sendCommand(MAC_TABLE, MAC_PREFIX, true);
-  sendCommand(MAC_TABLE, MAC_JOIN, true);
-  sendCommand(MAC_JOIN_TABLE, type, false);
+  writeCommand((char *)pgm_read_word(&(mac_join_commands[type])));
   modemStream->write(SEND_MSG);
   debugPrintLn();
   return waitForOk();
@@ -1435,65 +1684,53 @@ bool TheThingsNetwork::sendJoinSet(uint8_t type)
 
 bool TheThingsNetwork::sendPayload(uint8_t mode, uint8_t port, uint8_t *payload, size_t length)
 {
-  clearReadBuffer();
-  debugPrint(F(SENDING));
-  sendCommand(MAC_TABLE, MAC_PREFIX, true);
-  sendCommand(MAC_TABLE, MAC_TX, true);
-  sendCommand(MAC_TX_TABLE, mode, true);
-  char sport[4];
-  if (port > 99)
+  return writePayload(mode, port, payload, length) && waitForOk();
+}
+
+bool TheThingsNetwork::writePayload(uint8_t mode, uint8_t port, const uint8_t *payload, size_t length)
+{
+  // "mac tx uncnf 255 " at most, the hex payload and "\r\n"
+  if (length > (sizeof(buffer) - 20) / 2)
   {
-    sport[0] = ((port - (port % 100)) / 100) + 48;
-    sport[1] = (((port % 100) - (port % 10)) / 10) + 48;
-    sport[2] = (port % 10) + 48;
-    sport[3] = '\0';
+    return false;
   }
-  else if (port > 9)
+
+  // Compose the whole command line in buffer, the response is read into it only after it was sent
+  clearReadBuffer();
+  char *line = buffer;
+  strcpy_P(line, (char *)pgm_read_word(&(mac_tx_prefixes[mode])));
+  line += strlen(line);
+  uint8_t count = digits(port);
+  for (uint8_t d = count; d > 0; d--, port /= 10)
   {
-    sport[0] = ((port - (port % 10)) / 10) + 48;
-    sport[1] = (port % 10) + 48;
-    sport[2] = '\0';
+    line[d - 1] = (port % 10) + '0';
   }
-  else
+  line += count;
+  *line++ = ' ';
+  for (size_t i = 0; i < length; i++)
   {
-    sport[0] = port + 48;
-    sport[1] = '\0';
+    *line++ = pgm_read_byte(&(hex_digits[payload[i] >> 4]));
+    *line++ = pgm_read_byte(&(hex_digits[payload[i] & 0x0F]));
   }
-  modemStream->write(sport);
-  modemStream->print(" ");
-  debugPrint(sport);
-  debugPrint(F(" "));
-  uint8_t i = 0;
-  for (i = 0; i < length; i++)
-  {
-    if (payload[i] < 16)
-    {
-      modemStream->print("0");
-      modemStream->print(payload[i], HEX);
-      debugPrint(F("0"));
-      debugPrint(payload[i], HEX);
-    }
-    else
-    {
-      modemStream->print(payload[i], HEX);
-      debugPrint(payload[i], HEX);
-    }
-  }
-  modemStream->write(SEND_MSG);
-  debugPrintLn();
-  return waitForOk();
+  *line++ = '\r';
+  *line++ = '\n';
+  *line = '\0';
+
+  modemStream->write(buffer, line - buffer);
+  debugPrint(F(SENDING));
+  debugPrint(buffer);
+  return true;
 }
 
 void TheThingsNetwork::sleep(uint32_t mseconds)
 {
-  if (mseconds < 100)
+  if (mseconds < 100 || sendBusy())
   {
     return;
   }
 
   debugPrint(F(SENDING));
-  sendCommand(SYS_TABLE, SYS_PREFIX, true);
-  sendCommand(SYS_TABLE, SYS_SLEEP, true);
+  writeCommand(sys_sleep_prefix);
 
   sprintf(buffer, "%lu", mseconds);
   modemStream->write(buffer);
@@ -1503,15 +1740,22 @@ void TheThingsNetwork::sleep(uint32_t mseconds)
 
 void TheThingsNetwork::wake()
 {
+  if (sendBusy())
+  {
+    return;
+  }
   autoBaud();
 }
 
 void TheThingsNetwork::linkCheck(uint16_t seconds)
 {
+  if (sendBusy())
+  {
+    return;
+  }
   clearReadBuffer();
   debugPrint(SENDING);
-  sendCommand(MAC_TABLE, MAC_PREFIX, true);
-  sendCommand(MAC_TABLE, MAC_SET, true);
+  writeCommand(mac_set_prefix);
   sendCommand(MAC_GET_SET_TABLE, MAC_LINKCHK, true);
 
   sprintf(buffer, "%u", seconds);
@@ -26,6 +26,7 @@
 
 #define TTN_BUFFER_SIZE 300
 #define TTN_DEFAULT_TIMEOUT 10000	// Default modem timeout in ms
+#define TTN_SEND_TIMEOUT (3 * TTN_DEFAULT_TIMEOUT)	// Time service() waits for a response of an uplink, as readLine() with its 3 attempts
 
 typedef uint8_t port_t;
 
@@ -73,6 +74,42 @@ enum ttn_response_code_t
 	TTN_ERROR_ERR = (-12),
 };
 
+// First word of a modem response, the errors in the order of ttn_response_code_t
+enum ttn_modem_response_t
+{
+  TTN_RESPONSE_UNKNOWN = -1,
+  TTN_RESPONSE_OK,
+  TTN_RESPONSE_BUSY,
+  TTN_RESPONSE_FRAME_COUNTER_ERR,
+  TTN_RESPONSE_INVALID_CLASS,
+  TTN_RESPONSE_INVALID_DATA_LEN,
+  TTN_RESPONSE_INVALID_PARAM,
+  TTN_RESPONSE_KEYS_NOT_INIT,
+  TTN_RESPONSE_MAC_PAUSED,
+  TTN_RESPONSE_MULTICAST_KEYS_NOT_SET,
+  TTN_RESPONSE_NO_FREE_CH,
+  TTN_RESPONSE_NOT_JOINED,
+  TTN_RESPONSE_SILENT,
+  TTN_RESPONSE_ERR,
+  TTN_RESPONSE_ON,
+  TTN_RESPONSE_OFF,
+  TTN_RESPONSE_ACCEPTED,
+  TTN_RESPONSE_MAC_TX_OK,
+  TTN_RESPONSE_MAC_RX,
+  TTN_RESPONSE_MAC_ERR,
+  TTN_RESPONSE_RN2483,
+  TTN_RESPONSE_RN2483A,
+  TTN_RESPONSE_RN2903,
+  TTN_RESPONSE_RN2903AS
+};
+
+enum ttn_send_state_t
+{
+  TTN_SEND_IDLE,
+  TTN_SEND_WAIT_OK,
+  TTN_SEND_WAIT_RESULT
+};
+
 enum ttn_modem_status_t
 {
 	TTN_MODEM_READ_ERR = -1,
@@ -100,6 +137,10 @@ private:
   bool baudDetermined = false;
   void (*messageCallback)(const uint8_t *payload, size_t size, port_t port);
   lorawan_class_t lw_class = CLASS_A;
+  ttn_send_state_t sendState = TTN_SEND_IDLE;
+  unsigned long sendStart = 0;
+  size_t received = 0;
+  void (*sendCallback)(ttn_response_t response) = NULL;
 
   void clearReadBuffer();
   size_t readLine(char *buffer, size_t size, uint8_t attempts = 3);
@@ -123,12 +164,17 @@ private:
 
   ttn_response_t parseBytes();
   void sendCommand(uint8_t table, uint8_t index, bool appendSpace, bool print = true);
+  void writeCommand(const char *command, bool print = true);
   bool sendMacSet(uint8_t index, uint8_t value1, unsigned long value2);
   bool sendMacSet(uint8_t index, const char *value);
   bool sendChSet(uint8_t index, uint8_t channel, unsigned long value);
   bool sendChSet(uint8_t index, uint8_t channel, const char *value);
   bool sendJoinSet(uint8_t type);
   bool sendPayload(uint8_t mode, uint8_t port, uint8_t *payload, size_t len);
+  bool writePayload(uint8_t mode, uint8_t port, const uint8_t *payload, size_t len);
+  void serviceLine();
+  void finishSend(ttn_response_t response);
+  bool sendBusy();
   void sendGetValue(uint8_t table, uint8_t prefix, uint8_t index);
 
 public:
@@ -156,6 +202,7 @@ public:
   int8_t getPowerIndex();
   bool getChannelStatus (uint8_t channel);
   ttn_response_code_t getLastError();
+  static ttn_modem_response_t classifyResponse(const char *response);
   void onMessage(void (*cb)(const uint8_t *payload, size_t size, port_t port));
   bool provision(const char *appEui, const char *appKey, bool resetFirst = true);
   bool join(const char *appEui, const char *appKey, int8_t retries = -1, uint32_t retryDelay = 10000, lorawan_class_t = CLASS_A);
@@ -165,6 +212,14 @@ public:
   bool setClass(lorawan_class_t p_lw_class);
   ttn_response_t sendBytes(const uint8_t *payload, size_t length, port_t port = 1, bool confirm = false, uint8_t sf = 0);
   ttn_response_t poll(port_t port = 1, bool confirm = false, bool modem_only = false);
+  // Uplink without blocking: beginSend() writes "mac tx", service() must then be called until it returns
+  // false and the result goes to the onSendComplete() callback. The uplink uses buffer and the modem until
+  // then, so all blocking calls (sendBytes, poll, join, the get and set calls, ...) are refused while it
+  // is in progress: they print an error and return their failure value, such as TTN_ERROR_SEND_COMMAND_FAILED,
+  // false or 0.
+  bool beginSend(const uint8_t *payload, size_t length, port_t port = 1, bool confirm = false);
+  bool service();
+  void onSendComplete(void (*cb)(ttn_response_t response));
   void sleep(uint32_t mseconds);
   void wake();
   void saveState();
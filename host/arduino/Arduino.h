@@ -0,0 +1,67 @@
+/**
+ * @file  Arduino.h
+ * @brief Minimal Arduino.h for building the LPP library on a PC.
+ * @note  Only what the library sources in LoRa_TX_RX_Cayenne_HAN use is provided.
+ * @copyright (c) 2024, Leon Nguyen and Len Verploegen
+ *
+ * The MIT License (MIT), see CustomCayeneLPP.h.
+ *
+ * @author  Leon Nguyen and Len Verpleogen
+ */
+#ifndef _HOST_ARDUINO_H_
+#define _HOST_ARDUINO_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "pgmspace.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define LOW 0x0
+#define HIGH 0x1
+
+#define DEC 10
+#define HEX 16
+
+/**
+ * @brief Milliseconds since an arbitrary start, like millis() since the reset of the board.
+ */
+static inline unsigned long millis(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long)now.tv_sec * 1000UL + now.tv_nsec / 1000000L;
+}
+
+/**
+ * @brief Wait, the host never has to: the modem of a host build is simulated.
+ */
+static inline void delay(unsigned long ms) {
+	(void)ms;
+}
+
+/**
+ * @brief Pins do not exist on the host.
+ */
+static inline void digitalWrite(uint8_t pin, uint8_t value) {
+	(void)pin;
+	(void)value;
+}
+
+// Functions instead of the macros of the Arduino core, so <algorithm> still compiles
+template <typename T, typename U>
+static inline T min(T a, U b) {
+	return a < (T)b ? a : (T)b;
+}
+
+template <typename T, typename U>
+static inline T max(T a, U b) {
+	return a > (T)b ? a : (T)b;
+}
+
+#endif
@@ -0,0 +1,124 @@
+/**
+ * @file  Print.h
+ * @brief Print class of the Arduino core for building the TheThingsNetwork driver on a PC.
+ * @note  Follows Print.cpp of the AVR core, so a host build makes the same write() calls as the board.
+ * @copyright (c) 2024, Leon Nguyen and Len Verploegen
+ *
+ * The MIT License (MIT), see CustomCayeneLPP.h.
+ *
+ * @author  Leon Nguyen and Len Verpleogen
+ */
+#ifndef _HOST_PRINT_H_
+#define _HOST_PRINT_H_
+
+#include "Arduino.h"
+
+/**
+ * @brief Base of every output stream, only write(uint8_t) has to be implemented.
+ */
+class Print {
+public:
+	virtual ~Print() {}
+
+	virtual size_t write(uint8_t c) = 0;
+
+	/**
+	 * @brief Write a buffer, byte by byte unless the stream has a faster path (HardwareSerial on AVR has not).
+	 */
+	virtual size_t write(const uint8_t *buffer, size_t size) {
+		size_t n = 0;
+		while (size--) {
+			if (!write(*buffer++)) {
+				break;
+			}
+			n++;
+		}
+		return n;
+	}
+
+	size_t write(const char *str) {
+		return str ? write((const uint8_t *)str, strlen(str)) : 0;
+	}
+
+	size_t write(const char *buffer, size_t size) {
+		return write((const uint8_t *)buffer, size);
+	}
+
+	size_t print(const __FlashStringHelper *ifsh) {
+		const char *p = reinterpret_cast<const char *>(ifsh);
+		size_t n = 0;
+		for (uint8_t c; (c = pgm_read_byte(p++)) != 0; n++) {
+			if (!write(c)) {
+				break;
+			}
+		}
+		return n;
+	}
+
+	size_t print(const char str[]) {
+		return write(str);
+	}
+
+	size_t print(char c) {
+		return write((uint8_t)c);
+	}
+
+	size_t print(unsigned char b, int base = DEC) {
+		return print((unsigned long)b, base);
+	}
+
+	size_t print(int n, int base = DEC) {
+		return print((long)n, base);
+	}
+
+	size_t print(unsigned int n, int base = DEC) {
+		return print((unsigned long)n, base);
+	}
+
+	size_t print(long n, int base = DEC) {
+		if (base == 0) {
+			return write((uint8_t)n);
+		}
+		if (base == 10 && n < 0) {
+			return print('-') + printNumber(-(unsigned long)n, 10);
+		}
+		return printNumber(n, base);
+	}
+
+	size_t print(unsigned long n, int base = DEC) {
+		return base == 0 ? write((uint8_t)n) : printNumber(n, base);
+	}
+
+	size_t println(void) {
+		return write("\r\n");
+	}
+
+	template <typename T>
+	size_t println(T value) {
+		return print(value) + println();
+	}
+
+	template <typename T>
+	size_t println(T value, int base) {
+		return print(value, base) + println();
+	}
+
+private:
+	size_t printNumber(unsigned long n, uint8_t base) {
+		char buf[8 * sizeof(long) + 1];
+		char *str = &buf[sizeof(buf) - 1];
+
+		*str = '\0';
+		if (base < 2) {
+			base = 10;
+		}
+		do {
+			char c = n % base;
+			n /= base;
+			*--str = c < 10 ? c + '0' : c + 'A' - 10;
+		} while (n);
+		return write(str);
+	}
+};
+
+#endif
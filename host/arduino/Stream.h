@@ -0,0 +1,78 @@
+/**
+ * @file  Stream.h
+ * @brief Stream class of the Arduino core for building the TheThingsNetwork driver on a PC.
+ * @note  Follows Stream.cpp of the AVR core, the reads wait at most the timeout for the next byte.
+ * @copyright (c) 2024, Leon Nguyen and Len Verploegen
+ *
+ * The MIT License (MIT), see CustomCayeneLPP.h.
+ *
+ * @author  Leon Nguyen and Len Verpleogen
+ */
+#ifndef _HOST_STREAM_H_
+#define _HOST_STREAM_H_
+
+#include "Print.h"
+
+/**
+ * @brief Base of every input and output stream.
+ */
+class Stream : public Print {
+public:
+	Stream() : timeout(1000) {}
+
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+
+	void setTimeout(unsigned long timeout) {
+		this->timeout = timeout;
+	}
+
+	unsigned long getTimeout(void) {
+		return timeout;
+	}
+
+	/**
+	 * @brief Read into buffer until the terminator, which is not stored, length bytes or the timeout.
+	 * @return Number of bytes stored.
+	 */
+	size_t readBytesUntil(char terminator, char *buffer, size_t length) {
+		size_t index = 0;
+		while (index < length) {
+			int c = timedRead();
+			if (c < 0 || c == terminator) {
+				break;
+			}
+			buffer[index++] = (char)c;
+		}
+		return index;
+	}
+
+	size_t readBytes(char *buffer, size_t length) {
+		size_t count = 0;
+		while (count < length) {
+			int c = timedRead();
+			if (c < 0) {
+				break;
+			}
+			buffer[count++] = (char)c;
+		}
+		return count;
+	}
+
+protected:
+	unsigned long timeout;  ///< Milliseconds to wait for the next byte
+
+	int timedRead(void) {
+		unsigned long start = millis();
+		do {
+			int c = read();
+			if (c >= 0) {
+				return c;
+			}
+		} while (millis() - start < timeout);
+		return -1;
+	}
+};
+
+#endif
@@ -0,0 +1,35 @@
+/**
+ * @file  pgmspace.h
+ * @brief PROGMEM access for building the TheThingsNetwork driver on a PC.
+ * @note  The host has one address space, so flash reads are plain reads.
+ * @copyright (c) 2024, Leon Nguyen and Len Verploegen
+ *
+ * The MIT License (MIT), see CustomCayeneLPP.h.
+ *
+ * pgm_read_word() reads a whole pointer, not 16 bits: the driver only uses it on its tables of strings.
+ *
+ * @author  Leon Nguyen and Len Verpleogen
+ */
+#ifndef _HOST_PGMSPACE_H_
+#define _HOST_PGMSPACE_H_
+
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(addr))
+
+#define strcpy_P strcpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define memcpy_P memcpy
+#define memcmp_P memcmp
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(PSTR(s)))
+
+#endif
@@ -0,0 +1,69 @@
+/**
+ * @file  bench.h
+ * @brief Timing helpers shared by the host benchmarks.
+ * @copyright (c) 2024, Leon Nguyen and Len Verploegen
+ *
+ * The MIT License (MIT), see CustomCayeneLPP.h.
+ *
+ * @author  Leon Nguyen and Len Verpleogen
+ */
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+
+#define BENCH_MIN_NS 200000000.0  /// \ Minimum run time of a measurement, the iterations are doubled until reached
+
+/**
+ * @brief Keep the compiler from optimizing away the writes to p.
+ */
+static inline void benchClobber(const void *p) {
+	asm volatile("" : : "g"(p) : "memory");
+}
+
+/**
+ * @brief Measure the time of one call of f.
+ * @param f Function taking the iteration number, so inputs can change every call.
+ * @return Nanoseconds per call.
+ */
+template <typename F>
+double benchNs(F f) {
+	typedef std::chrono::steady_clock clock;
+
+	for (uint32_t i = 0; i < 1000; i++) {  // Warm up caches and branch predictors
+		f(i);
+	}
+	for (uint32_t iterations = 1000;; iterations *= 2) {
+		clock::time_point start = clock::now();
+		for (uint32_t i = 0; i < iterations; i++) {
+			f(i);
+		}
+		double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+		if (ns >= BENCH_MIN_NS) {
+			return ns / iterations;
+		}
+	}
+}
+
+/**
+ * @brief Print the header of the result table.
+ */
+static inline void benchHeader(const char *title) {
+	printf("\n%s\n", title);
+	printf("%-34s %8s %8s %10s %10s %12s\n", "case", "fields", "bytes", "ns/frame", "ns/field", "frames/s");
+}
+
+/**
+ * @brief Print one row of the result table.
+ * @param name Name of the case.
+ * @param ns Nanoseconds per frame.
+ * @param fields Number of fields in a frame.
+ * @param bytes Bytes per frame.
+ */
+static inline void benchReport(const char *name, double ns, unsigned fields, double bytes) {
+	printf("%-34s %8u %8.1f %10.1f %10.2f %12.0f\n", name, fields, bytes, ns, ns / fields, 1e9 / ns);
+}
+
+#endif
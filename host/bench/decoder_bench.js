@@ -0,0 +1,292 @@
+/**
+ * @file  decoder_bench.js
+ * @brief Benchmark of decodeUplink in payload.javascript with the frames of the KISS LoRa sketch.
+ * @note  Usage: node decoder_bench.js [path/to/payload.javascript]
+ *        The frames were written by the encoders in LoRa_TX_RX_Cayenne_HAN, see lpp_bench.cpp.
+ * @copyright (c) 2024, Leon Nguyen and Len Verploegen
+ *
+ * The MIT License (MIT), see CustomCayeneLPP.h.
+ *
+ * @author  Leon Nguyen and Len Verpleogen
+ */
+var fs = require('fs');
+var path = require('path');
+var v8 = require('v8');
+var vm = require('vm');
+
+var BENCH_MIN_NS = 200000000;   // Minimum run time of a measurement, the iterations are doubled until reached
+var REPLAY_UPLINKS = 1000000;   // Uplinks of the replay measurement
+
+var decoder = process.argv[2] || path.join(__dirname, '../../LoRa_TX_RX_Cayenne_HAN/payload.javascript');
+vm.runInThisContext(fs.readFileSync(decoder, 'utf8'), {'filename': decoder});
+
+// KissUplinkSchema frames, 8 fields each unless noted otherwise
+var cases = [
+    {'name': 'LPP, port 99',                'port': 99,  'fields': 8, 'hex': '006700D70168500265012C03000504710014FFD803E80502014A06660014031770'},
+    {'name': 'packed, port 100',            'port': 100, 'fields': 8, 'hex': '00D750012C050014FFD803E8014A001770'},
+    {'name': 'alarm bits, port 101',        'port': 101, 'fields': 2, 'hex': '84'},
+    {'name': 'delta keyframe, port 102',    'port': 102, 'fields': 8, 'hex': '8000AE03A001D8040A284FD00F940500E05D'},
+    {'name': 'delta, port 102',             'port': 102, 'fields': 8, 'hex': '000106002200090000000000'},
+    {'name': 'deadband full, port 103',     'port': 103, 'fields': 8, 'hex': 'FFB403A001FA040A1E4FD00F940500E05D'},
+    {'name': 'deadband 1 field, port 103',  'port': 103, 'fields': 1, 'hex': '80C803'},
+    {'name': 'time series 8, port 99',      'port': 99,  'fields': 1, 'hex': '0C0A670800000000003C00D700D800D900DA00DB00DC00DD00DE'},
+    {'name': 'custom types 4-9, port 99',   'port': 99,  'fields': 6, 'hex': '0104010205C80306FFFE0407FFFFFFFB0508FF4143E0060900520BB9'}
+];
+
+function hexToBytes(hex) {
+    var bytes = [];
+    for (var i = 0; i < hex.length; i += 2) {
+        bytes.push(parseInt(hex.substr(i, 2), 16));
+    }
+    return bytes;
+}
+
+// Type 9 frames of addCustomByte(11, 9, value, resolution, size), checked against the encoder in lpp_bench.cpp
+var custom_round_trip = [
+    {'hex': '0B09032204D2',     'value': 12.34},        // resolution 100, 2 bytes
+    {'hex': '0B0900512D',       'value': 4.5},          // resolution 10, 1 byte
+    {'hex': '0B091F43000DAC',   'value': 3.5},          // resolution 1000, 3 bytes
+    {'hex': '0B0901021F40',     'value': 250},          // resolution 32, 2 bytes
+    {'hex': '0B09FFFC00000FFF', 'value': 4095 / 8191}   // resolution 8191, 4 bytes
+];
+custom_round_trip.forEach(function (c) {
+    var value = decodeUplink({'bytes': hexToBytes(c.hex), 'fPort': 99}).data.custom_11;
+    if (typeof value != 'number' || Math.abs(value - c.value) > 1e-9) {
+        throw 'decodeUplink of ' + c.hex + ' gives custom_11 ' + value + ', expected ' + c.value;
+    }
+});
+
+function benchNs(f) {
+    for (var i = 0; i < 1000; i++) {   // Warm up the JIT
+        f(i);
+    }
+    for (var iterations = 1000;; iterations *= 2) {
+        var start = process.hrtime.bigint();
+        for (i = 0; i < iterations; i++) {
+            f(i);
+        }
+        var ns = Number(process.hrtime.bigint() - start);
+        if (ns >= BENCH_MIN_NS) {
+            return ns / iterations;
+        }
+    }
+}
+
+function pad(value, width) {
+    var text = String(value);
+    while (text.length < width) {
+        text = ' ' + text;
+    }
+    return text;
+}
+
+// Type bytes of 4096 frames in the field order of the sketch: 7 of 8 frames are KissUplinkSchema,
+// the 8th has the custom types 4-9 and a time series
+var dispatch_frames = [
+    [103, 104, 101, 0, 113, 2, 102, 3], [103, 104, 101, 0, 113, 2, 102, 3], [103, 104, 101, 0, 113, 2, 102, 3],
+    [103, 104, 101, 0, 113, 2, 102, 3], [103, 104, 101, 0, 113, 2, 102, 3], [103, 104, 101, 0, 113, 2, 102, 3],
+    [103, 104, 101, 0, 113, 2, 102, 3], [4, 5, 6, 7, 8, 9, 10]
+];
+var dispatch_corpus = [];
+for (var f = 0; f < 4096; f++) {
+    dispatch_corpus = dispatch_corpus.concat(dispatch_frames[f % dispatch_frames.length]);
+}
+
+// Type lookup of lppDecodeValue before lpp_dispatch: a sensor_types property, then a switch on the type byte
+function dispatchSensorTypes(s_type) {
+    var type = sensor_types[s_type];
+    if (typeof type == 'undefined') {
+        throw 'Sensor type error!: ' + s_type;
+    }
+    switch (s_type) {
+        case 4:   return 1;
+        case 9:   return 2;
+        case 10:  return 8;
+        case 113:
+        case 134: return type.size + 1;
+        case 136: return type.size + 2;
+        case 135: return type.size + 3;
+        default:  return type.size;
+    }
+}
+
+// Type lookup of lppDecodeValue with lpp_dispatch: a dense array, then a switch on the handler kind
+function dispatchDense(s_type) {
+    var type = lpp_dispatch[s_type];
+    if (typeof type == 'undefined') {
+        throw 'Sensor type error!: ' + s_type;
+    }
+    switch (type.kind) {
+        case LPP_BIT:    return 1;
+        case LPP_CUSTOM: return 2;
+        case LPP_SERIES: return 8;
+        case LPP_AXES:   return type.size + 1;
+        case LPP_GPS:    return type.size + 2;
+        case LPP_COLOUR: return type.size + 3;
+        default:         return type.size;
+    }
+}
+
+// Separate closures, so every dispatch function gets its own call site
+var dispatch_cases = [
+    ['sensor_types + switch (type)', function () {
+        var sink = 0;
+        for (var n = 0; n < dispatch_corpus.length; n++) {
+            sink += dispatchSensorTypes(dispatch_corpus[n]);
+        }
+        return sink;
+    }],
+    ['lpp_dispatch + switch (kind)', function () {
+        var sink = 0;
+        for (var n = 0; n < dispatch_corpus.length; n++) {
+            sink += dispatchDense(dispatch_corpus[n]);
+        }
+        return sink;
+    }]
+];
+
+console.log('\nType dispatch payload.javascript, ' + dispatch_corpus.length + ' fields');
+console.log('case                              ' + pad('ns/field', 11) + pad('fields/s', 13));
+dispatch_cases.forEach(function (c) {
+    var sink = 0;
+    var ns = benchNs(function () {
+        sink += c[1]();
+    }) / dispatch_corpus.length;
+    if (sink == 0) {
+        throw 'Nothing dispatched for ' + c[0];
+    }
+    console.log((c[0] + '                                  ').substr(0, 34) + ' ' + pad(ns.toFixed(2), 10) + ' ' +
+                pad((1e9 / ns).toFixed(0), 12));
+});
+
+console.log('\nDecoder payload.javascript, decodeUplink');
+console.log('case                              ' + pad('fields', 9) + pad('bytes', 9) + pad('ns/frame', 11) +
+            pad('ns/field', 11) + pad('frames/s', 13));
+cases.forEach(function (c) {
+    var input = {'bytes': hexToBytes(c.hex), 'fPort': c.port};
+    var sink = 0;
+    var ns = benchNs(function () {
+        sink += Object.keys(decodeUplink(input).data).length;
+    });
+    if (sink == 0) {
+        throw 'Nothing decoded for ' + c.name;
+    }
+    console.log((c.name + '                                  ').substr(0, 34) + ' ' + pad(c.fields, 8) + ' ' +
+                pad(input.bytes.length.toFixed(1), 8) + ' ' + pad(ns.toFixed(1), 10) + ' ' +
+                pad((ns / c.fields).toFixed(2), 10) + ' ' + pad((1e9 / ns).toFixed(0), 12));
+});
+
+// The LPP frame of the first case as a stream: whole, and in chunks as a gateway bridge would pass them on
+var stream_bytes = hexToBytes(cases[0].hex);
+var stream_cases = [
+    ['lppDecode, whole frame', null],
+    ['lppDecodeStream, whole frame', stream_bytes.length],
+    ['lppDecodeStream, 8-byte chunks', 8],
+    ['lppDecodeStream, 1-byte chunks', 1]
+];
+
+console.log('\nStream decoder payload.javascript, ' + cases[0].name);
+console.log('case                              ' + pad('fields', 9) + pad('bytes', 9) + pad('ns/frame', 11) +
+            pad('ns/field', 11) + pad('frames/s', 13));
+stream_cases.forEach(function (c) {
+    var chunks = [];
+    for (var n = 0; c[1] && n < stream_bytes.length; n += c[1]) {
+        chunks.push(stream_bytes.slice(n, n + c[1]));
+    }
+    var sink = 0;
+    var ns = benchNs(function () {
+        var data = {};
+        if (c[1]) {
+            var state = {};
+            for (var k = 0; k < chunks.length; k++) {
+                lppDecodeStream(chunks[k], state, data);
+            }
+            lppEndStream(state);
+        } else {
+            lppDecode(stream_bytes, 0, data);
+        }
+        sink += Object.keys(data).length;
+    });
+    if (sink == 0) {
+        throw 'Nothing decoded for ' + c[0];
+    }
+    console.log((c[0] + '                                  ').substr(0, 34) + ' ' + pad(cases[0].fields, 8) + ' ' +
+                pad(stream_bytes.length.toFixed(1), 8) + ' ' + pad(ns.toFixed(1), 10) + ' ' +
+                pad((ns / cases[0].fields).toFixed(2), 10) + ' ' + pad((1e9 / ns).toFixed(0), 12));
+});
+
+// decodeUplink as it was before the flat output: a sensors array per uplink, flattened
+// with a key string built for every field
+function decodeUplinkArrays(input) {
+    var bytes = input.bytes;
+    var fPort = input.fPort;
+    var response = {};
+    var frame;
+    if (typeof delta_schemas[fPort] != 'undefined') {
+        frame = lppDecodeDelta(bytes, packed_schemas[delta_schemas[fPort]]);
+        response['keyframe'] = frame.keyframe;
+        response['keyframe_id'] = frame.keyframe_id;
+        response['counter'] = frame.counter;
+    } else if (typeof deadband_schemas[fPort] != 'undefined') {
+        frame = lppDecodeDeadband(bytes, packed_schemas[deadband_schemas[fPort]]);
+        response['omitted'] = frame.omitted;
+    } else if (typeof packed_schemas[fPort] != 'undefined') {
+        frame = lppDecodePacked(bytes, packed_schemas[fPort]);
+    } else {
+        frame = {'sensors': [], 'size': 0};
+    }
+    var sensors = frame.sensors.concat(lppDecode(bytes.slice(frame.size)));
+    sensors.forEach(function (field) {
+        response[field['name'] + '_' + field['channel']] = field['value'];
+    });
+    return {data: response};
+}
+
+// Replays the cases round robin and reports the garbage collections of the replay.
+// v8.GCProfiler needs node 18.15, older versions only report the time.
+function replay(name, decode) {
+    var inputs = cases.map(function (c) {
+        return {'bytes': hexToBytes(c.hex), 'fPort': c.port};
+    });
+    var profiler = v8.GCProfiler ? new v8.GCProfiler() : null;
+    var sink = 0;
+
+    for (var n = 0; n < 10000; n++) {   // Warm up the JIT
+        sink += Object.keys(decode(inputs[n % inputs.length]).data).length;
+    }
+    if (profiler) {
+        profiler.start();
+    }
+    var start = process.hrtime.bigint();
+    for (n = 0; n < REPLAY_UPLINKS; n++) {
+        sink += Object.keys(decode(inputs[n % inputs.length]).data).length;
+    }
+    var ns = Number(process.hrtime.bigint() - start) / REPLAY_UPLINKS;
+    if (sink == 0) {
+        throw 'Nothing decoded for ' + name;
+    }
+
+    var line = (name + '                                  ').substr(0, 34) + ' ' + pad(ns.toFixed(1), 10) + ' ' +
+               pad((1e9 / ns).toFixed(0), 12);
+    if (profiler) {
+        // Allocated bytes: the growth of the heap between the collections
+        var gcs = profiler.stop().statistics;
+        var allocated = 0, pause = 0, used = null;
+        gcs.forEach(function (gc) {
+            if (used !== null) {
+                allocated += gc.beforeGC.heapStatistics.usedHeapSize - used;
+            }
+            used = gc.afterGC.heapStatistics.usedHeapSize;
+            pause += gc.cost;
+        });
+        line += ' ' + pad((allocated / REPLAY_UPLINKS).toFixed(0), 10) + ' ' + pad(gcs.length, 8) + ' ' +
+                pad((pause / 1000).toFixed(1), 9);
+    }
+    console.log(line);
+}
+
+console.log('\nReplay payload.javascript, ' + REPLAY_UPLINKS + ' uplinks of the cases above');
+console.log('case                              ' + pad('ns/uplink', 11) + pad('uplinks/s', 13) + pad('bytes/upl', 11) +
+            pad('GCs', 9) + pad('GC ms', 10));
+replay('sensors array + key strings', decodeUplinkArrays);
+replay('decodeUplink, interned keys', decodeUplink);
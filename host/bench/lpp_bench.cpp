@@ -0,0 +1,610 @@
+/**
+ * @file  lpp_bench.cpp
+ * @brief Host benchmark of the LPP encoders and decoders with the field mix of the KISS LoRa sketch.
+ * @note  Reports ns/field, frames/s and bytes/frame, run it after every encoder change.
+ * @copyright (c) 2024, Leon Nguyen and Len Verploegen
+ *
+ * The MIT License (MIT), see CustomCayeneLPP.h.
+ *
+ * @author  Leon Nguyen and Len Verpleogen
+ */
+#include "bench.h"
+#include "CustomCayeneLPP.h"
+#include "KissUplinkSchema.h"
+#include "LppDeadband.h"
+#include "LppDelta.h"
+#include "LppDecoder.h"
+#include "LppDeviceCache.h"
+#include "LppStreamDecoder.h"
+#include "LppTriplets.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <unordered_map>
+
+#define READINGS 64  ///< Number of different sensor readings the cases cycle through
+#define TRIPLETS 4096  ///< Number of frames of the triplet batch
+#define DEVICES 100000  ///< Number of devices of the device cache cases
+
+/// Readings in the units the sketch gets from its sensors, see loop() in LoRa_TX_RX_Cayenne_HAN.ino.
+struct Reading {
+	int16_t temperature;  ///< 0.01 °C
+	int16_t humidity;     ///< 0.01 %RH
+	uint16_t luminosity;  ///< lux
+	uint8_t rotary;       ///< Rotary switch position
+	int16_t x, y, z;      ///< mG
+	uint16_t vdd;         ///< mV
+	uint32_t interval;    ///< ms
+};
+
+static Reading readings[READINGS];
+static Reading quietReadings[READINGS];
+
+/// Float values as the sketch had them before the integer path.
+struct FloatReading {
+	float temperature, humidity, luminosity, x, y, z, vdd, interval;
+	uint8_t rotary;
+};
+
+static FloatReading floatReadings[READINGS];
+
+static void initReadings(void) {
+	for (int i = 0; i < READINGS; i++) {
+		Reading &r = readings[i];
+		r.temperature = 2000 + i * 7;
+		r.humidity = 4000 + i * 31;
+		r.luminosity = 100 + i * 53;
+		r.rotary = i % 10;
+		r.x = 20 + i * 3;
+		r.y = -40 - i;
+		r.z = 1000 - i * 2;
+		r.vdd = 3300 - i * 5;
+		r.interval = 60000;
+
+		// Sensor noise that stays within the deadbands of the sketch
+		Reading &q = quietReadings[i];
+		q = readings[0];
+		q.temperature += (i & 3) * 10;
+		q.humidity += (i & 1) * 100;
+		q.luminosity += i & 7;
+
+		FloatReading &f = floatReadings[i];
+		f.temperature = r.temperature / 100.0f;
+		f.humidity = r.humidity / 100.0f;
+		f.luminosity = r.luminosity;
+		f.rotary = r.rotary;
+		f.x = r.x / 1000.0f;
+		f.y = r.y / 1000.0f;
+		f.z = r.z / 1000.0f;
+		f.vdd = r.vdd / 1000.0f;
+		f.interval = r.interval / 1000.0f;
+	}
+}
+
+static inline void scaleReading(int32_t *values, const Reading &r) {
+	KissUplinkSchema::scale(values, lppScaled(r.temperature, -1), lppScaled((r.humidity + 25) / 50), r.luminosity,
+	                        r.rotary, lppScaled(r.x), lppScaled(r.y), lppScaled(r.z), lppScaled(r.vdd, -1), 0,
+	                        lppScaled(r.interval, -1));
+}
+
+/// Deadbands of uplinkDeadbands in LoRa_TX_RX_Cayenne_HAN.ino.
+static const uint16_t deadbands[KissUplinkSchema::fields] = {5, 4, 20, 0, 100, 5, 0, 0};
+
+static void benchEncoders(void) {
+	StaticCayenneLPP<LPP_PAYLOAD_MAX_SIZE> lpp;
+	double ns;
+
+	benchHeader("Encoders, KissUplinkSchema field mix (8 fields, 10 values)");
+
+	ns = benchNs([&](uint32_t i) {
+		const FloatReading &f = floatReadings[i % READINGS];
+		lpp.reset();
+		lpp.addWord(LPP_CH_TEMPERATURE, LPP_TEMPERATURE, f.temperature, 10);
+		lpp.addByte(LPP_CH_HUMIDITY, LPP_RELATIVE_HUMIDITY, f.humidity, 2);
+		lpp.addWord(LPP_CH_LUMINOSITY, LPP_LUMINOSITY, f.luminosity, 1);
+		lpp.addByte(LPP_CH_ROTARYSWITCH, LPP_DIGITAL_INPUT, f.rotary, 1);
+		lpp.add3Float(LPP_CH_ACCELEROMETER, LPP_ACCELEROMETER, f.x, f.y, f.z, 100);
+		lpp.addWord(LPP_CH_BOARDVCCVOLTAGE, LPP_ANALOG_INPUT, f.vdd, 100);
+		lpp.addByte(LPP_CH_PRESENCE, LPP_PRESENCE, 0.0f, 1);
+		lpp.addWord(LPP_CH_SET_INTERVAL, LPP_ANALOG_OUTPUT, f.interval, 100);
+		benchClobber(lpp.getBuffer());
+	});
+	benchReport("CayenneLPP add*, float", ns, KissUplinkSchema::fields, lpp.getSize());
+
+	ns = benchNs([&](uint32_t i) {
+		const Reading &r = readings[i % READINGS];
+		lpp.reset();
+		lpp.addWord(LPP_CH_TEMPERATURE, LPP_TEMPERATURE, (int16_t)lppScale(r.temperature, -1));
+		lpp.addByte(LPP_CH_HUMIDITY, LPP_RELATIVE_HUMIDITY, (int16_t)((r.humidity + 25) / 50));
+		lpp.addWord(LPP_CH_LUMINOSITY, LPP_LUMINOSITY, (int16_t)r.luminosity);
+		lpp.addByte(LPP_CH_ROTARYSWITCH, LPP_DIGITAL_INPUT, (int16_t)r.rotary);
+		lpp.add3Word(LPP_CH_ACCELEROMETER, LPP_ACCELEROMETER, r.x, r.y, r.z);
+		lpp.addWord(LPP_CH_BOARDVCCVOLTAGE, LPP_ANALOG_INPUT, (int16_t)lppScale(r.vdd, -1));
+		lpp.addByte(LPP_CH_PRESENCE, LPP_PRESENCE, (int16_t)0);
+		lpp.addWord(LPP_CH_SET_INTERVAL, LPP_ANALOG_OUTPUT, (int16_t)lppScale(r.interval, -1));
+		benchClobber(lpp.getBuffer());
+	});
+	benchReport("CayenneLPP add*, integer", ns, KissUplinkSchema::fields, lpp.getSize());
+
+	ns = benchNs([&](uint32_t i) {
+		const FloatReading &f = floatReadings[i % READINGS];
+		lpp.reset();
+		lpp.addSchema<KissUplinkSchema>(f.temperature, f.humidity, f.luminosity, f.rotary, f.x, f.y, f.z, f.vdd, 0,
+		                                f.interval);
+		benchClobber(lpp.getBuffer());
+	});
+	benchReport("addSchema, float", ns, KissUplinkSchema::fields, lpp.getSize());
+
+	ns = benchNs([&](uint32_t i) {
+		const FloatReading &f = floatReadings[i % READINGS];
+		lpp.reset();
+		lpp.addSchemaPacked<KissUplinkSchema>(f.temperature, f.humidity, f.luminosity, f.rotary, f.x, f.y, f.z,
+		                                      f.vdd, 0, f.interval);
+		benchClobber(lpp.getBuffer());
+	});
+	benchReport("addSchemaPacked, float", ns, KissUplinkSchema::fields, lpp.getSize());
+
+	ns = benchNs([&](uint32_t i) {
+		const Reading &r = readings[i % READINGS];
+		lpp.reset();
+		lpp.addSchemaPacked<KissUplinkSchema>(lppScaled(r.temperature, -1), lppScaled((r.humidity + 25) / 50),
+		                                      r.luminosity, r.rotary, lppScaled(r.x), lppScaled(r.y),
+		                                      lppScaled(r.z), lppScaled(r.vdd, -1), 0, lppScaled(r.interval, -1));
+		benchClobber(lpp.getBuffer());
+	});
+	benchReport("addSchemaPacked, integer", ns, KissUplinkSchema::fields, lpp.getSize());
+
+	LppDeltaEncoder delta(KissUplinkSchema::count, 10);
+	uint32_t bytes = 0, frames = 0;
+	ns = benchNs([&](uint32_t i) {
+		int32_t values[KissUplinkSchema::count];
+		scaleReading(values, readings[i % READINGS]);
+		lpp.reset();
+		uint8_t *frame = lpp.reserve(lpp.getAvailable());
+		bytes += lpp.commit(delta.encode(values, frame, lpp.getAvailable()));
+		frames++;
+		benchClobber(lpp.getBuffer());
+	});
+	benchReport("LppDeltaEncoder, keyframe every 10", ns, KissUplinkSchema::fields, (double)bytes / frames);
+
+	const Reading *sets[2] = {readings, quietReadings};
+	const char *names[2] = {"LppDeadbandEncoder, all changed", "LppDeadbandEncoder, quiet"};
+	for (int n = 0; n < 2; n++) {
+		LppDeadbandEncoder deadband(KissUplinkSchema::axes, deadbands, KissUplinkSchema::fields, 30);
+		bytes = frames = 0;
+		ns = benchNs([&](uint32_t i) {
+			int32_t values[KissUplinkSchema::count];
+			scaleReading(values, sets[n][i % READINGS]);
+			lpp.reset();
+			uint8_t *frame = lpp.reserve(lpp.getAvailable());
+			bytes += lpp.commit(deadband.encode(values, frame, lpp.getAvailable()));
+			frames++;
+			benchClobber(lpp.getBuffer());
+		});
+		benchReport(names[n], ns, KissUplinkSchema::fields, (double)bytes / frames);
+	}
+
+	uint8_t alarm[1];
+	ns = benchNs([&](uint32_t i) {
+		LppBitWriter bits(alarm, sizeof(alarm));
+		bits.write(i & 1, 1);
+		bits.write(4, 7);
+		benchClobber(alarm);
+	});
+	benchReport("LppBitWriter, alarm frame", ns, 2, sizeof(alarm));
+}
+
+static void benchDecoders(void) {
+	uint8_t frames[READINGS][LPP_PAYLOAD_MAX_SIZE];
+	uint8_t sizes[READINGS];
+	uint32_t bytes = 0;
+	double ns;
+
+	benchHeader("Decoders");
+
+	// One keyframe followed by deltas, decoded in order like a network server would
+	LppDeltaEncoder encoder(KissUplinkSchema::count, READINGS);
+	for (int i = 0; i < READINGS; i++) {
+		int32_t values[KissUplinkSchema::count];
+		scaleReading(values, readings[i]);
+		sizes[i] = encoder.encode(values, frames[i], sizeof(frames[i]));
+		bytes += sizes[i];
+	}
+	LppDeltaDecoder decoder(KissUplinkSchema::count);
+	ns = benchNs([&](uint32_t i) {
+		int32_t values[KissUplinkSchema::count];
+		decoder.decode(frames[i % READINGS], sizes[i % READINGS], values);
+		benchClobber(values);
+	});
+	benchReport("LppDeltaDecoder", ns, KissUplinkSchema::fields, (double)bytes / READINGS);
+
+	uint8_t alarm[1] = {0x84};
+	ns = benchNs([&](uint32_t i) {
+		LppBitReader bits(alarm, sizeof(alarm));
+		uint32_t presence = bits.read(1);
+		uint32_t release = bits.read(7);
+		benchClobber(&presence);
+		benchClobber(&release);
+		alarm[0] ^= i & 0x80;
+	});
+	benchReport("LppBitReader, alarm frame", ns, 2, sizeof(alarm));
+}
+
+/// Visitor that touches every decoded value, as an ingest service that stores them would.
+struct SumVisitor {
+	double sum;
+	unsigned fields;
+
+	void onValue(uint8_t, const LppTypeInfo &, const double *values, uint8_t count) {
+		for (uint8_t n = 0; n < count; n++) {
+			sum += values[n];
+		}
+		fields++;
+	}
+
+	void onSeries(uint8_t, const LppSeries &series) {
+		for (uint8_t n = 0; n < series.count; n++) {
+			sum += series.sample(n);
+		}
+		fields++;
+	}
+};
+
+/// Visitor that keeps the last value, for the round trip checks.
+struct LastVisitor {
+	uint8_t channel;
+	double value;
+	unsigned fields;
+
+	void onValue(uint8_t channel, const LppTypeInfo &, const double *values, uint8_t) {
+		this->channel = channel;
+		value = values[0];
+		fields++;
+	}
+
+	void onSeries(uint8_t, const LppSeries &) {
+		fields++;
+	}
+};
+
+/**
+ * @brief Encode custom type 9 values with addCustomByte() and decode them with lppDecode().
+ * The frames are the ones decoder_bench.js checks decodeUplink with, so all three ends agree.
+ */
+static void checkCustomRoundTrip(void) {
+	static const struct {
+		float value;
+		uint16_t resolution;
+		uint8_t size;
+		const char *hex;
+	} cases[] = {
+		{12.34f, 100, 2, "0B09032204D2"},
+		{4.5f, 10, 1, "0B0900512D"},
+		{3.5f, 1000, 3, "0B091F43000DAC"},
+		{250.0f, 32, 2, "0B0901021F40"},
+		{0.5f, 8191, 4, "0B09FFFC00000FFF"},
+	};
+
+	for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+		StaticCayenneLPP<LPP_PAYLOAD_MAX_SIZE> lpp;
+		lpp.addCustomByte(11, LPP_CUSTOMBYTE, cases[c].value, cases[c].resolution, cases[c].size);
+
+		char hex[2 * LPP_PAYLOAD_MAX_SIZE + 1];
+		for (uint8_t i = 0; i < lpp.getSize(); i++) {
+			sprintf(hex + 2 * i, "%02X", lpp.getBuffer()[i]);
+		}
+		LastVisitor visitor = {0, 0, 0};
+		lppDecode(lpp.getBuffer(), lpp.getSize(), visitor);
+		double expected = (double)(uint32_t)(cases[c].value * cases[c].resolution) / cases[c].resolution;
+
+		if (strcmp(hex, cases[c].hex) != 0 || visitor.fields != 1 || visitor.channel != 11 ||
+		    fabs(visitor.value - expected) > 1e-9) {
+			printf("addCustomByte(11, 9, %g, %u, %u) = %s decodes to %g, expected %s and %g\n", cases[c].value,
+			       cases[c].resolution, cases[c].size, hex, visitor.value, cases[c].hex, expected);
+			exit(1);
+		}
+	}
+}
+
+static void benchNativeDecoder(void) {
+	// Frames of decoder_bench.js, so the numbers compare with decodeUplink in payload.javascript
+	static const struct {
+		const char *name;
+		const char *hex;
+	} cases[] = {
+		{"lppDecode, LPP port 99 (layout)", "006700D70168500265012C03000504710014FFD803E80502014A06660014031770"},
+		{"lppDecode, time series 8", "0C0A670800000000003C00D700D800D900DA00DB00DC00DD00DE"},
+		{"lppDecode, custom types 4-9", "0104010205C80306FFFE0407FFFFFFFB0508FF4143E0060900520BB9"},
+	};
+
+	benchHeader("Native decoder, host/decoder/LppDecoder.h");
+
+	for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+		uint8_t frame[LPP_PAYLOAD_MAX_SIZE];
+		size_t size = strlen(cases[c].hex) / 2;
+		for (size_t i = 0; i < size; i++) {
+			unsigned byte;
+			sscanf(cases[c].hex + 2 * i, "%2x", &byte);
+			frame[i] = byte;
+		}
+
+		SumVisitor visitor = {0, 0};
+		lppDecode(frame, size, visitor);
+		unsigned fields = visitor.fields;
+
+		double ns = benchNs([&](uint32_t) {
+			lppDecode(frame, size, visitor);
+			benchClobber(&visitor);
+		});
+		benchReport(cases[c].name, ns, fields, size);
+
+		if (c == 0) {
+			// The first frame has the KissUplinkSchema layout, compare with the field by field path
+			SumVisitor generic = {0, 0};
+			lppDecodeGeneric(frame, size, generic);
+			SumVisitor fixed = {0, 0};
+			lppDecode(frame, size, fixed);
+			if (generic.sum != fixed.sum || generic.fields != fixed.fields) {
+				printf("lppDecode of the KissUplinkSchema layout differs from lppDecodeGeneric\n");
+				exit(1);
+			}
+			ns = benchNs([&](uint32_t) {
+				lppDecodeGeneric(frame, size, visitor);
+				benchClobber(&visitor);
+			});
+			benchReport("lppDecodeGeneric, LPP port 99", ns, fields, size);
+
+			// The first frame again as a stream, whole and in chunks as a gateway bridge would pass them on
+			static const size_t chunks[] = {LPP_PAYLOAD_MAX_SIZE, 8, 1};
+			static const char *names[] = {"LppStreamDecoder, whole frame", "LppStreamDecoder, 8-byte chunks",
+			                              "LppStreamDecoder, 1-byte chunks"};
+			LppStreamDecoder stream;
+
+			for (size_t k = 0; k < sizeof(chunks) / sizeof(chunks[0]); k++) {
+				ns = benchNs([&](uint32_t) {
+					for (size_t n = 0; n < size; n += chunks[k]) {
+						stream.feed(frame + n, size - n < chunks[k] ? size - n : chunks[k], visitor);
+					}
+					stream.finish();
+					benchClobber(&visitor);
+				});
+				benchReport(names[k], ns, fields, size);
+			}
+		}
+	}
+}
+
+/// Type bytes of 8 frames in the field order of the sketch, as dispatch_frames in decoder_bench.js.
+static const uint8_t dispatchFrames[] = {
+	103, 104, 101, 0, 113, 2, 102, 3,  103, 104, 101, 0, 113, 2, 102, 3,  103, 104, 101, 0, 113, 2, 102, 3,
+	103, 104, 101, 0, 113, 2, 102, 3,  103, 104, 101, 0, 113, 2, 102, 3,  103, 104, 101, 0, 113, 2, 102, 3,
+	103, 104, 101, 0, 113, 2, 102, 3,  4, 5, 6, 7, 8, 9, 10
+};
+
+static const LppTypeInfo *searchTable[256];
+static size_t searchTableSize;
+
+/// Type lookup of lppDecodeValue() before lppTypes: a search of the sensor_types entries, then a switch on the type byte.
+static inline uint8_t dispatchSearch(uint8_t type) {
+	const LppTypeInfo *info = NULL;
+	for (size_t i = 0; i < searchTableSize; i++) {
+		if (searchTable[i]->type == type) {
+			info = searchTable[i];
+			break;
+		}
+	}
+	if (!info) {
+		return 0;
+	}
+	switch (type) {
+		case 4:  return 1;
+		case 9:  return 2;
+		case 10: return 8;
+		default: return info->size;
+	}
+}
+
+/// Type lookup of lppDecodeValue() with lppTypes: one index, then a switch on the handler kind.
+static inline uint8_t dispatchDense(uint8_t type) {
+	const LppTypeInfo *info = lppFindType(type);
+	if (!info) {
+		return 0;
+	}
+	switch (info->kind) {
+		case LPP_KIND_BIT:    return 1;
+		case LPP_KIND_CUSTOM: return 2;
+		case LPP_KIND_SERIES: return 8;
+		default:              return info->size;
+	}
+}
+
+static void benchTypeDispatch(void) {
+	for (unsigned type = 0; type < 256; type++) {
+		if (lppFindType(type)) {
+			searchTable[searchTableSize++] = lppFindType(type);
+		}
+	}
+
+	benchHeader("Type dispatch, 8 frames of the sketch");
+	unsigned sum = 0;
+	double ns = benchNs([&](uint32_t) {
+		for (size_t n = 0; n < sizeof(dispatchFrames); n++) {
+			sum += dispatchSearch(dispatchFrames[n]);
+		}
+		benchClobber(&sum);
+	});
+	benchReport("search + switch (type)", ns, sizeof(dispatchFrames), 0);
+	ns = benchNs([&](uint32_t) {
+		for (size_t n = 0; n < sizeof(dispatchFrames); n++) {
+			sum += dispatchDense(dispatchFrames[n]);
+		}
+		benchClobber(&sum);
+	});
+	benchReport("lppTypes + switch (kind)", ns, sizeof(dispatchFrames), 0);
+}
+
+static void benchTriplets(void) {
+	static uint8_t frames[TRIPLETS][LPP_PAYLOAD_MAX_SIZE];
+	static uint8_t sizes[TRIPLETS];
+	static uint8_t gathered[TRIPLETS * LPP_TRIPLET_SIZE];
+	static float x[TRIPLETS], y[TRIPLETS], z[TRIPLETS], check[3][TRIPLETS];
+	static const struct {
+		const char *name;
+		lpp_simd_t simd;
+	} paths[] = {
+		{"lppUnpackTriplets, scalar", LPP_SIMD_SCALAR},
+		{"lppUnpackTriplets, SSSE3", LPP_SIMD_SSSE3},
+		{"lppUnpackTriplets, AVX2", LPP_SIMD_AVX2},
+	};
+
+	// Uplinks of the sketch with a different accelerometer reading in every frame
+	for (int f = 0; f < TRIPLETS; f++) {
+		const Reading &r = readings[f % READINGS];
+		CayenneLPP lpp(frames[f], LPP_PAYLOAD_MAX_SIZE);
+		lpp.addWord(LPP_CH_TEMPERATURE, LPP_TEMPERATURE, (int16_t)lppScale(r.temperature, -1));
+		lpp.addByte(LPP_CH_HUMIDITY, LPP_RELATIVE_HUMIDITY, (int16_t)((r.humidity + 25) / 50));
+		lpp.addWord(LPP_CH_LUMINOSITY, LPP_LUMINOSITY, (int16_t)r.luminosity);
+		lpp.addByte(LPP_CH_ROTARYSWITCH, LPP_DIGITAL_INPUT, (int16_t)r.rotary);
+		lpp.add3Word(LPP_CH_ACCELEROMETER, LPP_ACCELEROMETER, r.x - f, r.y + f, r.z ^ f);
+		sizes[f] = lpp.getSize();
+	}
+
+	benchHeader("Triplets, accelerometer of 4096 frames, per triplet");
+	double ns = benchNs([&](uint32_t) {
+		for (int f = 0; f < TRIPLETS; f++) {
+			memcpy(gathered + f * LPP_TRIPLET_SIZE, lppFindValue(frames[f], sizes[f], LPP_CH_ACCELEROMETER, LPP_ACCELEROMETER),
+			       LPP_TRIPLET_SIZE);
+		}
+		benchClobber(gathered);
+	});
+	benchReport("gather, lppFindValue", ns / TRIPLETS, 3, LPP_TRIPLET_SIZE);
+
+	// The per-axis path of lppDecodeValue()
+	ns = benchNs([&](uint32_t) {
+		for (int t = 0; t < TRIPLETS; t++) {
+			const uint8_t *triplet = gathered + t * LPP_TRIPLET_SIZE;
+			check[0][t] = lppReadDecimal(triplet, 2, true, 1000);
+			check[1][t] = lppReadDecimal(triplet + 2, 2, true, 1000);
+			check[2][t] = lppReadDecimal(triplet + 4, 2, true, 1000);
+		}
+		benchClobber(check);
+	});
+	benchReport("lppReadDecimal per axis", ns / TRIPLETS, 3, LPP_TRIPLET_SIZE);
+
+	for (size_t p = 0; p < sizeof(paths) / sizeof(paths[0]); p++) {
+		if (paths[p].simd > lppSimdLevel()) {
+			printf("%-34s not supported by this CPU\n", paths[p].name);
+			continue;
+		}
+		ns = benchNs([&](uint32_t) {
+			lppUnpackTriplets(gathered, TRIPLETS, 1000, x, y, z, paths[p].simd);
+			benchClobber(x);
+		});
+		for (int t = 0; t < TRIPLETS; t++) {
+			if (x[t] != check[0][t] || y[t] != check[1][t] || z[t] != check[2][t]) {
+				printf("%s differs at triplet %d\n", paths[p].name, t);
+				exit(1);
+			}
+		}
+		benchReport(paths[p].name, ns / TRIPLETS, 3, LPP_TRIPLET_SIZE);
+	}
+}
+
+static void benchDeviceCache(void) {
+	typedef std::chrono::steady_clock clock;
+	static uint64_t devEuis[DEVICES];
+	uint8_t frames[READINGS][LPP_PAYLOAD_MAX_SIZE];
+	uint8_t sizes[READINGS];
+	uint32_t bytes = 0;
+	double ns;
+
+	// One keyframe followed by deltas, every device sends the same frames
+	LppDeltaEncoder encoder(KissUplinkSchema::count, READINGS);
+	for (int i = 0; i < READINGS; i++) {
+		int32_t values[KissUplinkSchema::count];
+		scaleReading(values, readings[i]);
+		sizes[i] = encoder.encode(values, frames[i], sizeof(frames[i]));
+		bytes += sizes[i];
+	}
+
+	// DevEUIs of one vendor, the uplinks of the devices arrive interleaved in random order
+	uint64_t random = 1;
+	for (int d = 0; d < DEVICES; d++) {
+		random = random * 6364136223846793005ULL + 1442695040888963407ULL;
+		devEuis[d] = 0x70B3D57ED0000000ULL | (random >> 36);
+	}
+
+	std::unordered_map<uint64_t, LppDeltaDecoder> decoders;
+	LppDeviceCache cache;
+	for (int d = 0; d < DEVICES; d++) {
+		int32_t values[KissUplinkSchema::count];
+		decoders.insert(std::make_pair(devEuis[d], LppDeltaDecoder(KissUplinkSchema::count)))
+		        .first->second.decode(frames[0], sizes[0], values);
+		cache.decodeDelta(devEuis[d], APPLICATION_PORT_DELTA, KissUplinkSchema::count, frames[0], sizes[0], values);
+	}
+
+	benchHeader("Device cache, delta uplinks of 100000 devices");
+	ns = benchNs([&](uint32_t i) {
+		int32_t values[KissUplinkSchema::count];
+		uint32_t frame = 1 + (i / DEVICES) % (READINGS - 1);
+		decoders.find(devEuis[i % DEVICES])->second.decode(frames[frame], sizes[frame], values);
+		benchClobber(values);
+	});
+	benchReport("unordered_map + LppDeltaDecoder", ns, KissUplinkSchema::fields, (double)bytes / READINGS);
+
+	ns = benchNs([&](uint32_t i) {
+		int32_t values[KissUplinkSchema::count];
+		uint32_t frame = 1 + (i / DEVICES) % (READINGS - 1);
+		cache.decodeDelta(devEuis[i % DEVICES], APPLICATION_PORT_DELTA, KissUplinkSchema::count, frames[frame],
+		                  sizes[frame], values);
+		benchClobber(values);
+	});
+	benchReport("LppDeviceCache::decodeDelta", ns, KissUplinkSchema::fields, (double)bytes / READINGS);
+
+	// Snapshot and restore once, per device
+	const char *path = "lpp_bench_devices.snapshot";
+	double fileBytes = sizeof(uint64_t) + sizeof(LppDeviceState);
+	clock::time_point start = clock::now();
+	if (!cache.snapshot(path)) {
+		printf("LppDeviceCache::snapshot failed\n");
+		exit(1);
+	}
+	ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+	benchReport("LppDeviceCache::snapshot, per dev", ns / DEVICES, 1, fileBytes * cache.capacity() / DEVICES);
+
+	LppDeviceCache restored(16);
+	start = clock::now();
+	if (!restored.restore(path)) {
+		printf("LppDeviceCache::restore failed\n");
+		exit(1);
+	}
+	ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+	unlink(path);
+	benchReport("LppDeviceCache::restore, per dev", ns / DEVICES, 1, fileBytes * cache.capacity() / DEVICES);
+
+	// The restored devices decode deltas without new keyframes
+	for (int d = 0; d < DEVICES; d++) {
+		int32_t values[KissUplinkSchema::count], check[KissUplinkSchema::count];
+		if (restored.decodeDelta(devEuis[d], APPLICATION_PORT_DELTA, KissUplinkSchema::count, frames[1], sizes[1],
+		                         values) != LPP_DELTA_OK ||
+		    decoders.find(devEuis[d])->second.decode(frames[1], sizes[1], check) != LPP_DELTA_OK ||
+		    memcmp(values, check, sizeof(values)) != 0) {
+			printf("Restored device %d differs\n", d);
+			exit(1);
+		}
+	}
+}
+
+int main(void) {
+	initReadings();
+	checkCustomRoundTrip();
+	benchEncoders();
+	benchDecoders();
+	benchNativeDecoder();
+	benchTypeDispatch();
+	benchTriplets();
+	benchDeviceCache();
+
+	return 0;
+}
@@ -0,0 +1,424 @@
+/**
+ * @file  ttn_bench.cpp
+ * @brief Host benchmark of the UART path of an uplink in the TheThingsNetwork driver of the sketch.
+ * @note  The RN2483 is simulated, so only the time the driver spends on the board is measured.
+ * @copyright (c) 2024, Leon Nguyen and Len Verploegen
+ *
+ * The MIT License (MIT), see CustomCayeneLPP.h.
+ *
+ * @author  Leon Nguyen and Len Verpleogen
+ */
+#include "bench.h"
+#include "KissUplinkSchema.h"
+#include "TheThingsNetwork.h"
+
+#include <string>
+
+#define MODEM_BUFFER_SIZE 1024  ///< Size of the receive buffer of the simulated modem
+
+/**
+ * @brief RN2483 on a serial port: answers ok to every command line, and the result to "mac tx".
+ * The bytes of write(buffer, size) are stored one at a time, like HardwareSerial on AVR does.
+ */
+class SimulatedModem : public Stream {
+public:
+	SimulatedModem() : bytes(0), calls(0), keep(false), result("mac_tx_ok"), head(0), tail(0), length(0) {}
+
+	size_t write(uint8_t c) {
+		calls++;
+		put(c);
+		return 1;
+	}
+
+	size_t write(const uint8_t *buffer, size_t size) {
+		calls++;
+		for (size_t i = 0; i < size; i++) {
+			put(buffer[i]);
+		}
+		return size;
+	}
+
+	int available() {
+		return tail - head;
+	}
+
+	int read() {
+		return head < tail ? rx[head++] : -1;
+	}
+
+	int peek() {
+		return head < tail ? rx[head] : -1;
+	}
+
+	uint32_t bytes;        ///< Bytes written
+	uint32_t calls;        ///< Calls of write() by the driver
+	bool keep;             ///< Keep the command lines in sent
+	std::string sent;      ///< Command lines written while keep is set
+	const char *result;    ///< Answer to "mac tx" after the RX windows
+
+private:
+	uint8_t rx[MODEM_BUFFER_SIZE];  ///< Answers not read yet
+	size_t head, tail;
+	char line[600];                 ///< Command line being written
+	size_t length;
+
+	void put(uint8_t c) {
+		bytes++;
+		if (length < sizeof(line)) {
+			line[length++] = c;
+		}
+		if (c == '\n') {
+			if (keep) {
+				sent.append(line, length);
+			}
+			answer("ok\r\n");
+			if (length >= 6 && memcmp(line, "mac tx", 6) == 0) {
+				answer(result);
+				answer("\r\n");
+			}
+			length = 0;
+		}
+	}
+
+	void answer(const char *text) {
+		if (head == tail) {
+			head = tail = 0;
+		}
+		size_t size = strlen(text);
+		memcpy(rx + tail, text, size);
+		tail += size;
+	}
+};
+
+/**
+ * @brief Serial monitor of the debug output, only counts the bytes.
+ */
+class DebugSink : public Stream {
+public:
+	DebugSink() : bytes(0) {}
+
+	size_t write(uint8_t c) {
+		(void)c;
+		bytes++;
+		return 1;
+	}
+
+	int available() {
+		return 0;
+	}
+
+	int read() {
+		return -1;
+	}
+
+	int peek() {
+		return -1;
+	}
+
+	uint32_t bytes;  ///< Bytes written
+};
+
+/**
+ * @brief The command line the RN2483 expects for an uplink.
+ */
+static std::string expectedLine(const uint8_t *payload, size_t size, port_t port, bool confirm) {
+	char text[8];
+	std::string line = confirm ? "mac tx cnf " : "mac tx uncnf ";
+
+	snprintf(text, sizeof(text), "%u ", port);
+	line += text;
+	for (size_t i = 0; i < size; i++) {
+		snprintf(text, sizeof(text), "%02X", payload[i]);
+		line += text;
+	}
+	return line + "\r\n";
+}
+
+static ttn_response_t lastResponse;  ///< Response of the last uplink started with beginSend()
+static uint32_t downlinks;           ///< Downlinks received
+static uint8_t downlink[256];        ///< Last downlink
+static size_t downlinkSize;          ///< Size of the last downlink
+static port_t downlinkPort;          ///< Port of the last downlink
+
+static void sendComplete(ttn_response_t response) {
+	lastResponse = response;
+}
+
+static void message(const uint8_t *payload, size_t size, port_t port) {
+	memcpy(downlink, payload, size);
+	downlinkPort = port;
+	downlinks++;
+	downlinkSize = size;
+}
+
+/**
+ * @brief Send one uplink, with sendBytes() or with beginSend() and service().
+ */
+static inline ttn_response_t sendUplink(TheThingsNetwork &ttn, const uint8_t *payload, size_t size, port_t port,
+                                        bool confirm, bool async) {
+	if (!async) {
+		return ttn.sendBytes(payload, size, port, confirm);
+	}
+	lastResponse = TTN_ERROR_SEND_COMMAND_FAILED;
+	if (ttn.beginSend(payload, size, port, confirm)) {
+		while (ttn.service()) {
+		}
+	}
+	return lastResponse;
+}
+
+/**
+ * @brief Measure the UART path of one uplink.
+ * @param result Line the simulated modem answers after the RX windows.
+ * @return false when the driver did not send the expected command line or did not report the result.
+ */
+static bool benchUplink(const char *name, size_t size, port_t port, bool confirm, bool async,
+                        const char *result = "mac_tx_ok") {
+	SimulatedModem modem;
+	DebugSink debug;
+	TheThingsNetwork ttn(modem, debug, TTN_FP_EU868);
+	uint8_t payload[256];
+	bool received = strncmp(result, "mac_rx", 6) == 0;
+	static const uint8_t expectedDownlink[] = {0x14, 0x02, 0x00, 0x64};  // Downlink of the cases with "mac_rx 99 ..."
+
+	for (size_t i = 0; i < size; i++) {
+		payload[i] = (uint8_t)(i * 37 + 5);  // Includes bytes below 0x10
+	}
+	ttn.onSendComplete(sendComplete);
+	ttn.onMessage(message);
+	modem.result = result;
+
+	modem.keep = true;
+	downlinks = 0;
+	ttn_response_t response = sendUplink(ttn, payload, size, port, confirm, async);
+	if (response != (received ? TTN_SUCCESSFUL_RECEIVE : TTN_SUCCESSFUL_TRANSMISSION) ||
+	    downlinks != (received ? 1u : 0u) ||
+	    (received && (downlinkPort != 99 || downlinkSize != sizeof(expectedDownlink) ||
+	                  memcmp(downlink, expectedDownlink, downlinkSize))) ||
+	    modem.sent != expectedLine(payload, size, port, confirm)) {
+		printf("%-34s response %d, %u downlinks, sent \"%s\"\n", name, response, downlinks, modem.sent.c_str());
+		return false;
+	}
+	modem.keep = false;
+
+	uint32_t bytes = modem.bytes, calls = modem.calls, debugBytes = debug.bytes;
+	double ns = benchNs([&](uint32_t i) {
+		payload[0] = (uint8_t)i;
+		sendUplink(ttn, payload, size, port, confirm, async);
+	});
+	printf("%-34s %8u %8u %8u %8u %12.1f\n", name, (unsigned)size, bytes, calls, debugBytes, ns);
+	return true;
+}
+
+/**
+ * @brief Check that the blocking calls are refused while an uplink of beginSend() is in progress.
+ * @return false when a blocking call talked to the modem, or the uplink did not complete.
+ */
+static bool checkSendBusy(void) {
+	SimulatedModem modem;
+	DebugSink debug;
+	TheThingsNetwork ttn(modem, debug, TTN_FP_EU868);
+	const uint8_t payload[] = {0x01, 0x02};
+	bool ok = true;
+
+	ttn.onSendComplete(sendComplete);
+	lastResponse = TTN_ERROR_SEND_COMMAND_FAILED;
+	modem.keep = true;
+	ok &= ttn.beginSend(payload, sizeof(payload), 1, false);
+	ok &= !ttn.beginSend(payload, sizeof(payload), 1, false);
+	ok &= ttn.sendBytes(payload, sizeof(payload), 1, false) == TTN_ERROR_SEND_COMMAND_FAILED;
+	ok &= ttn.poll(1, false) == TTN_ERROR_SEND_COMMAND_FAILED;
+	ok &= !ttn.setDR(5);
+	ok &= ttn.getVDD() == 0;
+	ok &= !ttn.getChannelStatus(3);
+	ttn.linkCheck(60);
+	ok &= modem.sent == expectedLine(payload, sizeof(payload), 1, false);
+
+	// The uplink completes as if nothing happened, after that the blocking calls work again
+	while (ttn.service()) {
+	}
+	ok &= lastResponse == TTN_SUCCESSFUL_TRANSMISSION;
+	ok &= ttn.setDR(5);
+	if (!ok) {
+		printf("%-34s sent \"%s\"\n", "blocking calls during beginSend()", modem.sent.c_str());
+	}
+	return ok;
+}
+
+/// Configuration command of the driver and the lines it should send.
+struct ModemCommand {
+	const char *name;
+	bool (*send)(TheThingsNetwork &ttn);
+	const char *lines;
+};
+
+static const ModemCommand commands[] = {
+	{"setChannel(3, 867700000, 0, 5)", [](TheThingsNetwork &ttn) { return ttn.setChannel(3, 867700000, 0, 5); },
+	 "mac set ch freq 3 867700000\r\nmac set ch drrange 3 0 5\r\n"},
+	{"setChannelStatus(3, true)", [](TheThingsNetwork &ttn) { return ttn.setChannelStatus(3, true); },
+	 "mac set ch status 3 on\r\n"},
+	{"setDR(5)", [](TheThingsNetwork &ttn) { return ttn.setDR(5); }, "mac set dr 5\r\n"},
+	{"getChannelStatus(3)", [](TheThingsNetwork &ttn) { return ttn.getChannelStatus(3) || true; },
+	 "mac get ch status 3\r\n"},
+	{"getVDD()", [](TheThingsNetwork &ttn) { return ttn.getVDD() == 0; }, "sys get vdd\r\n"},
+	{"linkCheck(60)", [](TheThingsNetwork &ttn) { ttn.linkCheck(60); return true; }, "mac set linkchk 60\r\n"},
+};
+
+#define COMMANDS (sizeof(commands) / sizeof(commands[0]))
+
+/**
+ * @brief Measure the configuration commands, the simulated modem answers ok to all of them.
+ * @return false when a command did not send the expected lines.
+ */
+static bool benchCommands(void) {
+	bool ok = true;
+
+	printf("\nConfiguration commands, same modem\n");
+	printf("%-34s %8s %8s %8s %12s\n", "case", "bytes", "writes", "debug", "ns/command");
+	for (size_t i = 0; i < COMMANDS; i++) {
+		SimulatedModem modem;
+		DebugSink debug;
+		TheThingsNetwork ttn(modem, debug, TTN_FP_EU868);
+		const ModemCommand &command = commands[i];
+
+		modem.keep = true;
+		if (!command.send(ttn) || modem.sent != command.lines) {
+			printf("%-34s sent \"%s\"\n", command.name, modem.sent.c_str());
+			ok = false;
+			continue;
+		}
+		modem.keep = false;
+
+		uint32_t bytes = modem.bytes, calls = modem.calls, debugBytes = debug.bytes;
+		double ns = benchNs([&](uint32_t) { command.send(ttn); });
+		printf("%-34s %8u %8u %8u %12.1f\n", command.name, bytes, calls, debugBytes, ns);
+	}
+	return ok;
+}
+
+/// Responses of an RN2483, with the first word the driver should recognize.
+struct ModemResponse {
+	const char *line;
+	ttn_modem_response_t response;
+};
+
+static const ModemResponse responses[] = {
+	{"ok", TTN_RESPONSE_OK},
+	{"mac_tx_ok", TTN_RESPONSE_MAC_TX_OK},
+	{"mac_rx 1 14020064", TTN_RESPONSE_MAC_RX},
+	{"mac_rx 99 0A0B0C0D0E0F101112131415161718191A1B1C1D1E1F", TTN_RESPONSE_MAC_RX},
+	{"mac_err", TTN_RESPONSE_MAC_ERR},
+	{"accepted", TTN_RESPONSE_ACCEPTED},
+	{"denied", TTN_RESPONSE_UNKNOWN},
+	{"on", TTN_RESPONSE_ON},
+	{"off", TTN_RESPONSE_OFF},
+	{"busy", TTN_RESPONSE_BUSY},
+	{"fram_counter_err_rejoin_needed", TTN_RESPONSE_FRAME_COUNTER_ERR},
+	{"invalid_class", TTN_RESPONSE_INVALID_CLASS},
+	{"invalid_data_len", TTN_RESPONSE_INVALID_DATA_LEN},
+	{"invalid_param", TTN_RESPONSE_INVALID_PARAM},
+	{"keys_not_init", TTN_RESPONSE_KEYS_NOT_INIT},
+	{"mac_paused", TTN_RESPONSE_MAC_PAUSED},
+	{"multicast_keys_not_set", TTN_RESPONSE_MULTICAST_KEYS_NOT_SET},
+	{"no_free_ch", TTN_RESPONSE_NO_FREE_CH},
+	{"not_joined", TTN_RESPONSE_NOT_JOINED},
+	{"silent", TTN_RESPONSE_SILENT},
+	{"err", TTN_RESPONSE_ERR},
+	{"RN2483 1.0.5 Oct 31 2018 15:06:52", TTN_RESPONSE_RN2483},
+	{"RN2483A 1.0.5 Oct 31 2018 15:06:52", TTN_RESPONSE_RN2483A},
+	{"RN2903 1.0.5 Nov 06 2018 10:45:27", TTN_RESPONSE_RN2903},
+	{"RN2903AS 1.0.5 Nov 06 2018 10:45:27", TTN_RESPONSE_RN2903AS},
+	{"radio_tx_ok", TTN_RESPONSE_UNKNOWN},
+	{"radio_err", TTN_RESPONSE_UNKNOWN},
+	{"0004A30B001A2B3C", TTN_RESPONSE_UNKNOWN},
+	{"3297", TTN_RESPONSE_UNKNOWN},
+	{"868100000", TTN_RESPONSE_UNKNOWN},
+	{"4/5", TTN_RESPONSE_UNKNOWN},
+	{"", TTN_RESPONSE_UNKNOWN},
+};
+
+#define RESPONSES (sizeof(responses) / sizeof(responses[0]))
+
+/// Words in the order of ttn_modem_response_t, for the lookup the driver had before classifyResponse().
+static const char *const responseWords[] = {
+	"ok", "busy", "fram_counter_err_rejoin_needed", "invalid_class", "invalid_data_len", "invalid_param", "keys_not_init",
+	"mac_paused", "multicast_keys_not_set", "no_free_ch", "not_joined", "silent", "err", "on", "off", "accepted",
+	"mac_tx_ok", "mac_rx", "mac_err", "RN2483", "RN2483A", "RN2903", "RN2903AS"};
+
+/**
+ * @brief pgmstrcmp() as the driver had it: copy the word to the stack, compare the shorter length.
+ */
+static int pgmstrcmp(const char *str1, uint8_t str2Index) {
+	if (0 == strlen(str1))
+		return -1;
+
+	char str2[128];
+	strcpy_P(str2, responseWords[str2Index]);
+	benchClobber(str2);
+	return memcmp(str1, str2, min(strlen(str1), strlen(str2)));
+}
+
+/**
+ * @brief Compare with every word in turn, as getLastError() did.
+ */
+static ttn_modem_response_t searchResponse(const char *line) {
+	for (uint8_t i = 0; i < sizeof(responseWords) / sizeof(responseWords[0]); i++) {
+		if (pgmstrcmp(line, i) == 0) {
+			return (ttn_modem_response_t)i;
+		}
+	}
+	return TTN_RESPONSE_UNKNOWN;
+}
+
+static bool benchResponses(void) {
+	bool ok = true;
+
+	for (size_t i = 0; i < RESPONSES; i++) {
+		ttn_modem_response_t response = TheThingsNetwork::classifyResponse(responses[i].line);
+		if (response != responses[i].response) {
+			printf("classifyResponse(\"%s\") = %d, expected %d\n", responses[i].line, response, responses[i].response);
+			ok = false;
+		}
+	}
+
+	printf("\nModem responses, %u lines of an RN2483\n", (unsigned)RESPONSES);
+	printf("%-34s %12s\n", "case", "ns/response");
+	double ns = benchNs([](uint32_t i) {
+		ttn_modem_response_t response = searchResponse(responses[i % RESPONSES].line);
+		benchClobber(&response);
+	});
+	printf("%-34s %12.1f\n", "pgmstrcmp() over all words", ns);
+	ns = benchNs([](uint32_t i) {
+		ttn_modem_response_t response = TheThingsNetwork::classifyResponse(responses[i % RESPONSES].line);
+		benchClobber(&response);
+	});
+	printf("%-34s %12.1f\n", "classifyResponse()", ns);
+	return ok;
+}
+
+int main(void) {
+	bool ok = true;
+
+	printf("\nUART path of sendBytes(), simulated RN2483 answering ok and the result at once\n");
+	printf("%-34s %8s %8s %8s %8s %12s\n", "case", "payload", "bytes", "writes", "debug", "ns/uplink");
+	ok &= benchUplink("alarm, port 101, confirmed", 2, APPLICATION_PORT_ALARM, true, false);
+	ok &= benchUplink("KissUplinkSchema packed, port 100", KissUplinkSchema::packedSize, APPLICATION_PORT_PACKED, false, false);
+	ok &= benchUplink("KissUplinkSchema LPP, port 99", KissUplinkSchema::size, APPLICATION_PORT_CAYENNE, false, false);
+	ok &= benchUplink("51 bytes (DR0 maximum), port 2", 51, 2, false, false);
+	ok &= benchUplink("222 bytes (DR5 maximum), port 1", 222, 1, false, false);
+	ok &= benchUplink("packed, 4 byte downlink", KissUplinkSchema::packedSize, APPLICATION_PORT_PACKED, false, false,
+	                  "mac_rx 99 14020064");
+
+	printf("\nUART path of beginSend() and service(), same modem\n");
+	printf("%-34s %8s %8s %8s %8s %12s\n", "case", "payload", "bytes", "writes", "debug", "ns/uplink");
+	ok &= benchUplink("alarm, port 101, confirmed", 2, APPLICATION_PORT_ALARM, true, true);
+	ok &= benchUplink("KissUplinkSchema packed, port 100", KissUplinkSchema::packedSize, APPLICATION_PORT_PACKED, false, true);
+	ok &= benchUplink("packed, 4 byte downlink", KissUplinkSchema::packedSize, APPLICATION_PORT_PACKED, false, true,
+	                  "mac_rx 99 14020064");
+	ok &= checkSendBusy();
+
+	ok &= benchCommands();
+	ok &= benchResponses();
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,596 @@
+/**
+ * @file  lpp_bulk.cpp
+ * @brief Bulk decoder for archived uplinks, writes one column file per name_channel.
+ * @note  Usage: lpp_bulk [-t threads] [-c chunk_kb] [-o output_dir | -n] [-b] input_file
+ *        -n decodes without writing the columns, to measure the decoder alone.
+ *        -b reads payloads without a prefix as base64 instead of hex.
+ * @copyright (c) 2024, Leon Nguyen and Len Verploegen
+ *
+ * The MIT License (MIT), see CustomCayeneLPP.h.
+ *
+ * Every input line is one uplink: an optional LoRaWAN port followed by a space or comma, and the
+ * payload in hex, or in base64 with -b. A payload prefixed with hex: or b64: is read in that encoding
+ * whatever -b says, so the encoding is never guessed from the characters. Empty lines and lines
+ * starting with # are skipped. Uplinks are decoded by
+ * their port with lppDecodeUplink() in LppDecoder.h, like decodeUplink(): the packed, delta and deadband
+ * frames of KissUplinkSchema.h on ports 100 to 103, and Cayenne LPP on port 99, on the other ports and
+ * without a port. The frame headers that decodeUplink adds (keyframe, counter, omitted) are not written.
+ *
+ * The input is memory mapped and cut into chunks at line boundaries. The main thread deals the chunks
+ * round robin to the worker threads and writes the decoded chunks in input order, so row n of every
+ * column file is input uplink n. A worker takes its own chunks in order and steals chunks from the end
+ * of the other queues when it has none left. Only BULK_WINDOW chunks per thread are dealt ahead of the
+ * chunk being written, so the decoded values in memory are bounded however large the input is.
+ *
+ * Columns are named like the keys of decodeUplink in payload.javascript: name_channel, with
+ * .x/.y/.z, .r/.g/.b, .latitude/.longitude/.altitude, .bit or .type/.time/.interval/.samples
+ * appended for values that decodeUplink returns as an object. The differences of a delta frame go to
+ * name_channel_delta, as decodeUplink has no keyframe to add them to either.
+ *
+ * @author  Leon Nguyen and Len Verpleogen
+ */
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <math.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "LppDecoder.h"
+
+#define BULK_LPP_PORT 99          /// \ Port of uplinks without a port, see APPLICATION_PORT_CAYENNE
+#define BULK_CHUNK_KB 1024        /// \ Default chunk size in kB
+#define BULK_WINDOW 4             /// \ Chunks per thread dealt to the workers ahead of the writer
+#define BULK_MAX_PAYLOAD 256      /// \ Longest payload in bytes, LoRaWAN allows at most 242
+#define BULK_SERIES 0xFF          /// \ Component of the time series sample column
+#define BULK_DELTA 0x1000000      /// \ Column id flag of the differences of a delta frame
+
+/**
+ * @brief Column id: type, channel and component of a value, so no strings are built while decoding.
+ */
+static inline uint32_t columnId(uint8_t type, uint8_t channel, uint8_t component) {
+	return ((uint32_t)type << 16) | ((uint32_t)channel << 8) | component;
+}
+
+/**
+ * @brief File name of a column, e.g. temperature_0, accelerometer_4.x or temperature_0_delta.
+ */
+static std::string columnName(uint32_t id) {
+	static const char *axes[] = {"x", "y", "z"};
+	static const char *colour[] = {"r", "g", "b"};
+	static const char *gps[] = {"latitude", "longitude", "altitude"};
+	static const char *series[] = {"type", "time", "interval"};
+	uint8_t type = id >> 16;
+	uint8_t component = id & 0xFF;
+	const LppTypeInfo *info = lppFindType(type);
+	std::string name = std::string(info->name) + "_" + std::to_string((id >> 8) & 0xFF);
+
+	if (id & BULK_DELTA) {
+		name += "_delta";
+	}
+
+	switch (type) {
+		case 4:
+			return name + ".bit";
+		case 10:
+			return name + "." + (component == BULK_SERIES ? "samples" : series[component]);
+		case 113:
+		case 134:
+			return name + "." + axes[component];
+		case 135:
+			return name + "." + colour[component];
+		case 136:
+			return name + "." + gps[component];
+		default:
+			return name;
+	}
+}
+
+/**
+ * @brief Print a value like printf("%.15g"), without printf for values with at most 7 decimals.
+ * The divisors of sensor_types are powers of 10 up to 10^6, so nearly all values take the fast path.
+ * @param value The value.
+ * @param text Buffer of at least 32 bytes.
+ * @return Length of the text.
+ */
+static size_t formatValue(double value, char *text) {
+	double scaled = value * 1e7;
+	if (fabs(value) < 1e8 && (fabs(value) >= 1e-4 || value == 0)) {
+		int64_t fixed = llround(scaled);
+		if (fabs(scaled - fixed) < 1e-4) {
+			char digits[24];
+			uint64_t magnitude = fixed < 0 ? -fixed : fixed;
+			int count = 0, decimals = 7;
+			while (decimals > 0 && magnitude % 10 == 0) {
+				magnitude /= 10;
+				decimals--;
+			}
+			do {
+				digits[count++] = '0' + magnitude % 10;
+				magnitude /= 10;
+			} while (magnitude > 0 || count <= decimals);
+
+			size_t length = 0;
+			if (fixed < 0) {
+				text[length++] = '-';
+			}
+			while (count > 0) {
+				if (count-- == decimals) {
+					text[length++] = '.';
+				}
+				text[length++] = digits[count];
+			}
+			return length;
+		}
+	}
+	return snprintf(text, 32, "%.15g", value);
+}
+
+/**
+ * @brief One decoded value of a chunk, the text is stored in the text buffer of the chunk.
+ */
+struct Cell {
+	uint32_t column;  ///< Column id
+	uint32_t row;     ///< Row within the chunk
+	uint32_t offset;  ///< Offset of the text
+	uint32_t length;  ///< Length of the text, 0 when a later field of the same record replaced it
+};
+
+/**
+ * @brief Decoded chunk, written by one worker and read by the writer.
+ */
+struct Chunk {
+	const char *begin;                ///< First input byte
+	const char *end;                  ///< Byte after the last input byte
+	uint32_t rows;                    ///< Number of uplinks
+	uint32_t frames[LPP_FRAME_KINDS]; ///< Uplinks decoded without error per kind of frame
+	uint32_t errors;                  ///< Uplinks that could not be decoded
+	std::vector<Cell> cells;          ///< Values in row order
+	std::string text;                 ///< Text of all values
+	bool ready;                       ///< Decoded, guarded by Bulk::readyMutex
+};
+
+/**
+ * @brief Visitor of lppDecodeUplink() that stores the values of one uplink as cells.
+ */
+struct CellWriter {
+	Chunk *chunk;
+	uint32_t row;
+	size_t first;  ///< First cell of the current uplink
+
+	void add(uint32_t column, double value) {
+		char text[32];
+		add(column, text, formatValue(value, text));
+	}
+
+	void add(uint32_t column, const char *text, size_t length) {
+		// A field that occurs twice in one uplink keeps the last value, as decodeUplink does
+		for (size_t i = first; i < chunk->cells.size(); i++) {
+			if (chunk->cells[i].column == column) {
+				chunk->cells[i].length = 0;
+			}
+		}
+		Cell cell = {column, row, (uint32_t)chunk->text.size(), (uint32_t)length};
+		chunk->text.append(text, length);
+		chunk->cells.push_back(cell);
+	}
+
+	void onValue(uint8_t channel, const LppTypeInfo &type, const double *values, uint8_t count) {
+		for (uint8_t n = 0; n < count; n++) {
+			add(columnId(type.type, channel, n), values[n]);
+		}
+	}
+
+	void onDelta(uint8_t channel, const LppTypeInfo &type, const double *values, uint8_t count) {
+		for (uint8_t n = 0; n < count; n++) {
+			add(columnId(type.type, channel, n) | BULK_DELTA, values[n]);
+		}
+	}
+
+	void onSeries(uint8_t channel, const LppSeries &series) {
+		std::string samples;
+		char text[32];
+
+		add(columnId(10, channel, 0), series.type->name, strlen(series.type->name));
+		add(columnId(10, channel, 1), series.time);
+		add(columnId(10, channel, 2), series.interval);
+		for (uint8_t n = 0; n < series.count; n++) {
+			if (n > 0) {
+				samples += ' ';
+			}
+			samples.append(text, formatValue(series.sample(n), text));
+		}
+		add(columnId(10, channel, BULK_SERIES), samples.data(), samples.size());
+	}
+};
+
+static int8_t hexDigit(char c) {
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+static int8_t base64Digit(char c) {
+	if (c >= 'A' && c <= 'Z') return c - 'A';
+	if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+	if (c >= '0' && c <= '9') return c - '0' + 52;
+	if (c == '+' || c == '-') return 62;
+	if (c == '/' || c == '_') return 63;
+	return -1;
+}
+
+/**
+ * @brief Parse a payload in hex.
+ * @return Number of bytes, or -1 when the payload is not valid hex.
+ */
+static int parseHex(const char *text, size_t length, uint8_t *bytes) {
+	if ((length % 2) != 0 || (length / 2) > BULK_MAX_PAYLOAD) {
+		return -1;
+	}
+	for (size_t i = 0; i < length; i += 2) {
+		int8_t high = hexDigit(text[i]), low = hexDigit(text[i + 1]);
+		if (high < 0 || low < 0) {
+			return -1;
+		}
+		bytes[i / 2] = (high << 4) | low;
+	}
+	return length / 2;
+}
+
+/**
+ * @brief Parse a payload in base64, with or without padding, standard or URL-safe alphabet.
+ * @return Number of bytes, or -1 when the payload is not valid base64.
+ */
+static int parseBase64(const char *text, size_t length, uint8_t *bytes) {
+	uint32_t bits = 0;
+	int count = 0, size = 0;
+	while (length > 0 && text[length - 1] == '=') {
+		length--;
+	}
+	for (size_t i = 0; i < length; i++) {
+		int8_t digit = base64Digit(text[i]);
+		if (digit < 0 || size >= BULK_MAX_PAYLOAD) {
+			return -1;
+		}
+		bits = (bits << 6) | digit;
+		if (++count == 4) {
+			bytes[size++] = bits >> 16;
+			bytes[size++] = bits >> 8;
+			bytes[size++] = bits;
+			bits = count = 0;
+		}
+	}
+	if (count == 1 || size + count > BULK_MAX_PAYLOAD) {
+		return -1;
+	}
+	if (count >= 2) {
+		bytes[size++] = bits >> (count == 2 ? 4 : 10);
+	}
+	if (count == 3) {
+		bytes[size++] = bits >> 2;
+	}
+	return size;
+}
+
+/**
+ * @brief Parse a payload in the encoding of its hex: or b64: prefix, or in the default encoding.
+ * @return Number of bytes, or -1 when the payload is not valid in its encoding.
+ */
+static int parsePayload(const char *text, size_t length, bool base64, uint8_t *bytes) {
+	if (length >= 4 && memcmp(text, "hex:", 4) == 0) {
+		return parseHex(text + 4, length - 4, bytes);
+	}
+	if (length >= 4 && memcmp(text, "b64:", 4) == 0) {
+		return parseBase64(text + 4, length - 4, bytes);
+	}
+	return base64 ? parseBase64(text, length, bytes) : parseHex(text, length, bytes);
+}
+
+/**
+ * @brief Decode all uplinks of a chunk.
+ * @param base64 Payloads without a prefix are base64 instead of hex.
+ */
+static void decodeChunk(Chunk &chunk, bool base64) {
+	CellWriter writer = {&chunk, 0, 0};
+	uint8_t bytes[BULK_MAX_PAYLOAD];
+
+	for (const char *line = chunk.begin; line < chunk.end;) {
+		const char *end = (const char *)memchr(line, '\n', chunk.end - line);
+		const char *next = end ? end + 1 : chunk.end;
+		if (!end) {
+			end = chunk.end;
+		}
+		while (end > line && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t')) {
+			end--;
+		}
+		if (end == line || *line == '#') {
+			line = next;
+			continue;
+		}
+
+		// Optional port in front of the payload
+		const char *payload = line;
+		unsigned port = BULK_LPP_PORT;
+		const char *separator = line;
+		while (separator < end && *separator >= '0' && *separator <= '9') {
+			separator++;
+		}
+		if (separator > line && separator < end && (*separator == ' ' || *separator == ',' || *separator == '\t')) {
+			port = strtoul(line, NULL, 10);
+			payload = separator + 1;
+		}
+
+		writer.row = chunk.rows++;
+		writer.first = chunk.cells.size();
+		int size = port <= 0xFF ? parsePayload(payload, end - payload, base64, bytes) : -1;
+		if (size < 0 || lppDecodeUplink(port, bytes, size, writer) != LPP_DECODE_OK) {
+			chunk.errors++;
+		} else {
+			lpp_frame_t frame;
+			lppFindSchema(port, &frame);
+			chunk.frames[frame]++;
+		}
+		line = next;
+	}
+}
+
+/**
+ * @brief Work-stealing pool of chunks, every worker owns a queue of chunks.
+ */
+struct Bulk {
+	std::vector<Chunk> chunks;
+	std::vector<std::deque<size_t> > queues;  ///< Chunks dealt and not yet taken per worker
+	std::vector<std::unique_ptr<std::mutex> > queueMutexes;
+	std::mutex readyMutex;
+	std::condition_variable readyChanged;     ///< A chunk was decoded
+	std::condition_variable dealtChanged;     ///< Chunks were dealt
+	size_t dealt;                             ///< Chunks dealt to the workers, guarded by readyMutex
+	bool stopped;                             ///< No more chunks are dealt, guarded by readyMutex
+	bool base64;                              ///< Payloads without a prefix are base64
+
+	Bulk() : dealt(0), stopped(false), base64(false) {
+	}
+
+	/**
+	 * @brief Deal the chunks before chunk end round robin to the workers.
+	 */
+	void deal(size_t end) {
+		std::lock_guard<std::mutex> lock(readyMutex);
+		for (; dealt < end && dealt < chunks.size(); dealt++) {
+			size_t worker = dealt % queues.size();
+			std::lock_guard<std::mutex> queueLock(*queueMutexes[worker]);
+			queues[worker].push_back(dealt);
+		}
+		dealtChanged.notify_all();
+	}
+
+	/**
+	 * @brief Deal no more chunks, the workers return after the chunk they are decoding.
+	 */
+	void stop(void) {
+		std::lock_guard<std::mutex> lock(readyMutex);
+		stopped = true;
+		dealtChanged.notify_all();
+	}
+
+	/**
+	 * @brief Take the next chunk of a worker, or steal one from the end of another run.
+	 * @return Chunk index, or -1 when all chunks are taken.
+	 */
+	long take(size_t worker) {
+		for (size_t n = 0; n < queues.size(); n++) {
+			size_t victim = (worker + n) % queues.size();
+			std::lock_guard<std::mutex> lock(*queueMutexes[victim]);
+			if (!queues[victim].empty()) {
+				size_t chunk;
+				if (n == 0) {
+					chunk = queues[victim].front();
+					queues[victim].pop_front();
+				} else {
+					chunk = queues[victim].back();
+					queues[victim].pop_back();
+				}
+				return chunk;
+			}
+		}
+		return -1;
+	}
+
+	void work(size_t worker) {
+		for (;;) {
+			size_t seen;
+			{
+				std::lock_guard<std::mutex> lock(readyMutex);
+				seen = dealt;
+			}
+			long chunk = take(worker);
+			if (chunk < 0) {
+				// Nothing to take, wait until the writer deals more chunks
+				std::unique_lock<std::mutex> lock(readyMutex);
+				if (stopped || dealt == chunks.size()) {
+					return;
+				}
+				dealtChanged.wait(lock, [this, seen] { return stopped || dealt != seen; });
+				continue;
+			}
+			decodeChunk(chunks[chunk], base64);
+			std::lock_guard<std::mutex> lock(readyMutex);
+			chunks[chunk].ready = true;
+			readyChanged.notify_one();
+		}
+	}
+};
+
+/**
+ * @brief Open column file with the number of rows written to it.
+ */
+struct Column {
+	FILE *file;
+	uint64_t rows;
+};
+
+/**
+ * @brief Add empty rows until the column has rows rows.
+ */
+static void padColumn(Column &column, uint64_t rows) {
+	for (; column.rows < rows; column.rows++) {
+		putc_unlocked('\n', column.file);
+	}
+}
+
+static void usage(void) {
+	fprintf(stderr, "usage: lpp_bulk [-t threads] [-c chunk_kb] [-o output_dir | -n] [-b] input_file\n");
+	exit(2);
+}
+
+int main(int argc, char **argv) {
+	unsigned threads = std::thread::hardware_concurrency();
+	size_t chunkSize = BULK_CHUNK_KB * 1024;
+	std::string output = "lpp_columns";
+	bool write = true, base64 = false;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "t:c:o:nb")) != -1) {
+		switch (opt) {
+			case 't': threads = atoi(optarg); break;
+			case 'c': chunkSize = (size_t)atoi(optarg) * 1024; break;
+			case 'o': output = optarg; break;
+			case 'n': write = false; break;
+			case 'b': base64 = true; break;
+			default: usage();
+		}
+	}
+	if (optind != argc - 1 || chunkSize == 0) {
+		usage();
+	}
+	if (threads == 0) {
+		threads = 1;
+	}
+
+	int fd = open(argv[optind], O_RDONLY);
+	struct stat info;
+	if (fd < 0 || fstat(fd, &info) != 0) {
+		fprintf(stderr, "lpp_bulk: %s: %s\n", argv[optind], strerror(errno));
+		return 1;
+	}
+	if (write && mkdir(output.c_str(), 0777) != 0 && errno != EEXIST) {
+		fprintf(stderr, "lpp_bulk: %s: %s\n", output.c_str(), strerror(errno));
+		return 1;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	size_t size = info.st_size;
+	const char *data = NULL;
+	if (size > 0) {
+		data = (const char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) {
+			fprintf(stderr, "lpp_bulk: mmap: %s\n", strerror(errno));
+			return 1;
+		}
+		madvise((void *)data, size, MADV_SEQUENTIAL);
+	}
+
+	// Cut the input into chunks that end on a line boundary
+	Bulk bulk;
+	bulk.base64 = base64;
+	for (size_t offset = 0; offset < size;) {
+		size_t end = offset + chunkSize;
+		if (end >= size) {
+			end = size;
+		} else {
+			const char *newline = (const char *)memchr(data + end, '\n', size - end);
+			end = newline ? (size_t)(newline - data) + 1 : size;
+		}
+		Chunk chunk = {data + offset, data + end, 0, {0}, 0, std::vector<Cell>(), std::string(), false};
+		bulk.chunks.push_back(chunk);
+		offset = end;
+	}
+
+	bulk.queues.resize(threads);
+	for (unsigned t = 0; t < threads; t++) {
+		bulk.queueMutexes.push_back(std::unique_ptr<std::mutex>(new std::mutex));
+	}
+	size_t window = (size_t)threads * BULK_WINDOW;
+	bulk.deal(window);
+	std::vector<std::thread> workers;
+	for (unsigned t = 0; t < threads; t++) {
+		workers.push_back(std::thread(&Bulk::work, &bulk, t));
+	}
+
+	// Write the chunks in input order while the workers continue
+	std::map<uint32_t, Column> columns;
+	uint64_t rows = 0, frames[LPP_FRAME_KINDS] = {0}, errors = 0;
+	bool failed = false;
+	for (size_t c = 0; !failed && c < bulk.chunks.size(); c++) {
+		Chunk &chunk = bulk.chunks[c];
+		bulk.deal(c + window);
+		{
+			std::unique_lock<std::mutex> lock(bulk.readyMutex);
+			bulk.readyChanged.wait(lock, [&chunk] { return chunk.ready; });
+		}
+		for (size_t i = 0; write && !failed && i < chunk.cells.size(); i++) {
+			const Cell &cell = chunk.cells[i];
+			if (cell.length == 0) {
+				continue;
+			}
+			std::map<uint32_t, Column>::iterator column = columns.find(cell.column);
+			if (column == columns.end()) {
+				std::string path = output + "/" + columnName(cell.column) + ".col";
+				Column created = {fopen(path.c_str(), "w"), 0};
+				if (!created.file) {
+					fprintf(stderr, "lpp_bulk: %s: %s\n", path.c_str(), strerror(errno));
+					failed = true;
+					break;
+				}
+				column = columns.insert(std::make_pair(cell.column, created)).first;
+			}
+			padColumn(column->second, rows + cell.row);
+			fwrite_unlocked(chunk.text.data() + cell.offset, 1, cell.length, column->second.file);
+			putc_unlocked('\n', column->second.file);
+			column->second.rows++;
+		}
+		rows += chunk.rows;
+		for (int f = 0; f < LPP_FRAME_KINDS; f++) {
+			frames[f] += chunk.frames[f];
+		}
+		errors += chunk.errors;
+		std::vector<Cell>().swap(chunk.cells);  // Free the chunk, so at most window chunks are in memory
+		std::string().swap(chunk.text);
+	}
+	// The workers must be joined before returning, also when writing failed
+	bulk.stop();
+	for (size_t t = 0; t < workers.size(); t++) {
+		workers[t].join();
+	}
+	for (std::map<uint32_t, Column>::iterator column = columns.begin(); column != columns.end(); ++column) {
+		padColumn(column->second, rows);
+		fclose(column->second.file);
+	}
+	if (failed) {
+		return 1;
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	fprintf(stderr, "%llu records (%llu LPP, %llu packed, %llu delta, %llu deadband, %llu errors), "
+	        "%zu columns, %zu chunks, %u threads\n", (unsigned long long)rows,
+	        (unsigned long long)frames[LPP_FRAME_LPP], (unsigned long long)frames[LPP_FRAME_PACKED],
+	        (unsigned long long)frames[LPP_FRAME_DELTA], (unsigned long long)frames[LPP_FRAME_DEADBAND],
+	        (unsigned long long)errors, columns.size(), bulk.chunks.size(), threads);
+	fprintf(stderr, "%.3f s, %.0f records/s, %.1f MB/s\n", seconds, rows / seconds, size / seconds / 1e6);
+
+	return errors ? 1 : 0;
+}
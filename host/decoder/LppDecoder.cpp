@@ -0,0 +1,168 @@
+#include "LppDecoder.h"
+
+// Generated by host/schema/lpp_schema.js from lpp_schema.json, do not edit
+// sensor_types in payload.javascript
+static const LppTypeInfo sensorTypes[] = {
+	{0,   LPP_KIND_VALUES, 1, "digital_in",   false, 1, {1, 1, 1}},
+	{1,   LPP_KIND_VALUES, 1, "digital_out",  false, 1, {1, 1, 1}},
+	{2,   LPP_KIND_VALUES, 2, "analog_in",    true,  1, {100, 100, 100}},
+	{3,   LPP_KIND_VALUES, 2, "analog_out",   true,  1, {100, 100, 100}},
+	{4,   LPP_KIND_BIT,    1, "bit",          false, 1, {1, 1, 1}},
+	{5,   LPP_KIND_VALUES, 1, "byte",         false, 1, {1, 1, 1}},
+	{6,   LPP_KIND_VALUES, 2, "2byte",        false, 1, {1, 1, 1}},
+	{7,   LPP_KIND_VALUES, 4, "4byte",        false, 1, {1, 1, 1}},
+	{8,   LPP_KIND_VALUES, 4, "float",        true,  1, {10000000, 10000000, 10000000}},
+	{9,   LPP_KIND_CUSTOM, 1, "custom",       false, 1, {1, 1, 1}},
+	{10,  LPP_KIND_SERIES, 8, "series",       false, 1, {1, 1, 1}},
+	{100, LPP_KIND_VALUES, 4, "generic",      false, 1, {1, 1, 1}},
+	{101, LPP_KIND_VALUES, 2, "illuminance",  false, 1, {1, 1, 1}},
+	{102, LPP_KIND_VALUES, 1, "presence",     false, 1, {1, 1, 1}},
+	{103, LPP_KIND_VALUES, 2, "temperature",  true,  1, {10, 10, 10}},
+	{104, LPP_KIND_VALUES, 1, "humidity",     false, 1, {2, 2, 2}},
+	{113, LPP_KIND_VALUES, 6, "accelerometer",true,  3, {1000, 1000, 1000}},
+	{115, LPP_KIND_VALUES, 2, "barometer",    false, 1, {10, 10, 10}},
+	{116, LPP_KIND_VALUES, 2, "voltage",      false, 1, {100, 100, 100}},
+	{117, LPP_KIND_VALUES, 2, "current",      false, 1, {1000, 1000, 1000}},
+	{118, LPP_KIND_VALUES, 4, "frequency",    false, 1, {1, 1, 1}},
+	{120, LPP_KIND_VALUES, 1, "percentage",   false, 1, {1, 1, 1}},
+	{121, LPP_KIND_VALUES, 2, "altitude",     true,  1, {1, 1, 1}},
+	{125, LPP_KIND_VALUES, 2, "concentration",false, 1, {1, 1, 1}},
+	{128, LPP_KIND_VALUES, 2, "power",        false, 1, {1, 1, 1}},
+	{130, LPP_KIND_VALUES, 4, "distance",     false, 1, {1000, 1000, 1000}},
+	{131, LPP_KIND_VALUES, 4, "energy",       false, 1, {1000, 1000, 1000}},
+	{132, LPP_KIND_VALUES, 2, "direction",    false, 1, {1, 1, 1}},
+	{133, LPP_KIND_VALUES, 4, "time",         false, 1, {1, 1, 1}},
+	{134, LPP_KIND_VALUES, 6, "gyrometer",    true,  3, {100, 100, 100}},
+	{135, LPP_KIND_VALUES, 3, "colour",       false, 3, {1, 1, 1}},
+	{136, LPP_KIND_VALUES, 9, "gps",          true,  3, {10000, 10000, 100}},
+	{142, LPP_KIND_VALUES, 1, "switch",       false, 1, {1, 1, 1}},
+};
+
+// packed_schemas, delta_schemas and deadband_schemas in payload.javascript
+static const LppPackedField packedKissUplinkSchema[] = {
+	{0, 103, 0},    // temperature
+	{1, 104, 0},    // humidity
+	{2, 101, 0},    // illuminance
+	{3, 0, 0},      // rotary switch
+	{4, 113, 0},    // accelerometer
+	{5, 2, 0},      // VDD
+	{6, 102, 0},    // presence
+	{20, 3, 0},     // interval
+};
+static const LppPackedField packedAlarmSchema[] = {
+	{6, 102, 1},    // presence
+	{90, 0, 7},     // software release
+};
+static const LppPackedSchema packedSchemas[] = {
+	{100, 102, 103, 8,  10, packedKissUplinkSchema},
+	{101, 0,   0,   2,  2,  packedAlarmSchema},
+};
+// End of generated code
+
+const LppTypeInfo *lppTypes[256];
+
+// Fills lppTypes once at load time, so a lookup is one index instead of a search of sensorTypes
+static struct LppTypeTable {
+	LppTypeTable() {
+		for (size_t i = 0; i < sizeof(sensorTypes) / sizeof(sensorTypes[0]); i++) {
+			lppTypes[sensorTypes[i].type] = &sensorTypes[i];
+		}
+	}
+} lppTypeTable;
+
+const LppPackedSchema *lppFindSchema(uint8_t port, lpp_frame_t *frame) {
+	// Every port carries one kind of frame of one schema, see lpp_schema.json
+	for (size_t i = 0; i < sizeof(packedSchemas) / sizeof(packedSchemas[0]); i++) {
+		if (packedSchemas[i].delta == port) {
+			*frame = LPP_FRAME_DELTA;
+			return &packedSchemas[i];
+		}
+		if (packedSchemas[i].deadband == port) {
+			*frame = LPP_FRAME_DEADBAND;
+			return &packedSchemas[i];
+		}
+		if (packedSchemas[i].port == port) {
+			*frame = LPP_FRAME_PACKED;
+			return &packedSchemas[i];
+		}
+	}
+	*frame = LPP_FRAME_LPP;
+	return NULL;
+}
+
+double lppReadBits(const uint8_t *bytes, size_t offset, uint8_t bits, bool isSigned, double divisor) {
+	uint64_t value = 0;
+
+	for (uint8_t left = bits; left > 0;) {
+		uint8_t room = 8 - (offset & 0x07);         // Unread bits in the current byte
+		uint8_t take = left < room ? left : room;   // Bits that come from the current byte
+		value = (value << take) | ((bytes[offset >> 3] >> (room - take)) & ((1 << take) - 1));
+		offset += take;
+		left -= take;
+	}
+	if (isSigned && bits > 0 && (value >> (bits - 1)) & 1) {
+		return ((double)value - (double)((uint64_t)1 << bits)) / divisor;
+	}
+	return value / divisor;
+}
+
+double lppReadDecimal(const uint8_t *bytes, uint8_t size, bool isSigned, double divisor) {
+	uint32_t value = 0;
+
+	for (uint8_t i = 0; i < size; i++) {
+		value = (value << 8) | bytes[i];
+	}
+	if (isSigned && size > 0 && size <= 4) {
+		uint32_t sign = (uint32_t)1 << (size * 8 - 1);
+		// Sign extend from size bytes, as value - 2^(size * 8) in arrayToDecimal
+		return (double)(int32_t)((value ^ sign) - sign) / divisor;
+	}
+	return value / divisor;
+}
+
+lpp_decode_result_t lppValueSize(const LppTypeInfo *info, const uint8_t *bytes, size_t size, size_t *used) {
+	switch (info->kind) {
+		case LPP_KIND_CUSTOM:  // 3-bit size in the second header byte
+			if (size < 2) {
+				return LPP_DECODE_TRUNCATED;
+			}
+			*used = 2 + (bytes[1] & 0x07);
+			return LPP_DECODE_OK;
+
+		case LPP_KIND_SERIES: { // Type and number of the samples in the first two bytes
+			if (size < 2) {
+				return LPP_DECODE_TRUNCATED;
+			}
+			const LppTypeInfo *sample = lppFindType(bytes[0]);
+			if (!sample) {
+				return LPP_DECODE_UNKNOWN_TYPE;
+			}
+			*used = 8 + bytes[1] * sample->size;
+			return LPP_DECODE_OK;
+		}
+
+		default:
+			*used = info->size;
+			return LPP_DECODE_OK;
+	}
+}
+
+const uint8_t *lppFindValue(const uint8_t *bytes, size_t size, uint8_t channel, uint8_t type) {
+	size_t i = 0;
+
+	while (i + 2 <= size) {
+		const LppTypeInfo *info = lppFindType(bytes[i + 1]);
+		const uint8_t *value = bytes + i + 2;
+		size_t left = size - i - 2;
+		size_t used;
+
+		if (!info || lppValueSize(info, value, left, &used) != LPP_DECODE_OK || used > left) {
+			return NULL;
+		}
+		if (bytes[i] == channel && bytes[i + 1] == type) {
+			return value;
+		}
+		i += 2 + used;
+	}
+	return NULL;
+}
@@ -0,0 +1,605 @@
+/**
+ * @file  LppDecoder.h
+ * @brief Native decoder for Cayenne LPP frames, for server-side ingest.
+ * @note  Mirrors lppDecode() and sensor_types in payload.javascript, including the custom types 4 to 10.
+ * @copyright (c) 2024, Leon Nguyen and Len Verploegen
+ *
+ * The MIT License (MIT), see CustomCayeneLPP.h.
+ *
+ * The decoder reads straight from the input bytes and reports every field to a visitor, nothing is
+ * allocated. A visitor is any class with these members:
+ *
+ *     void onValue(uint8_t channel, const LppTypeInfo &type, const double *values, uint8_t count);
+ *     void onSeries(uint8_t channel, const LppSeries &series);
+ *
+ * onValue gets 1 value, or 3 for the accelerometer, gyrometer, colour and GPS. The values are scaled
+ * by the divisor of the type, as payload.javascript does.
+ *
+ * lppDecodeUplink() also decodes the packed, delta and deadband frames of KissUplinkSchema.h by their
+ * port, like decodeUplink(). Its visitor needs one more member for the values of a delta frame, which
+ * are differences with a keyframe the decoder does not have:
+ *
+ *     void onDelta(uint8_t channel, const LppTypeInfo &type, const double *values, uint8_t count);
+ *
+ * @author  Leon Nguyen and Len Verpleogen
+ */
+#ifndef _LPPDECODER_H_
+#define _LPPDECODER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "LppDelta.h"
+
+#define LPP_DECODER_MAX_VALUES 3  /// \ Maximum number of values of one field
+#define LPP_LAYOUT_HEADER_SIZE 32 /// \ Bytes at the start of a frame compared by lppMatchLayout()
+
+/**
+ * @brief Result of lppDecode().
+ */
+enum lpp_decode_result_t
+{
+	LPP_DECODE_OK = 0,             ///< All fields decoded
+	LPP_DECODE_UNKNOWN_TYPE = (-1),///< Type not in sensor_types, the fields before it were reported
+	LPP_DECODE_TRUNCATED = (-2)    ///< Frame ends inside a field, the fields before it were reported
+};
+
+/**
+ * @brief Handler of a type in lppDecodeValue(), like the handler kinds of lpp_dispatch in payload.javascript.
+ */
+enum lpp_decode_kind_t
+{
+	LPP_KIND_VALUES = 0,  ///< count values of size / count bytes each
+	LPP_KIND_BIT,         ///< addBit, bit 0 of one byte
+	LPP_KIND_CUSTOM,      ///< addCustomByte, divisor and size in a 2-byte header
+	LPP_KIND_SERIES       ///< Time series
+};
+
+/**
+ * @brief One entry of sensor_types in payload.javascript.
+ */
+struct LppTypeInfo {
+	uint8_t type;                              ///< LPP type identifier
+	uint8_t kind;                              ///< Handler, see lpp_decode_kind_t
+	uint8_t size;                              ///< Size of the value in bytes, without the custom header of type 9
+	const char *name;                          ///< Name used in the decoded output
+	bool isSigned;                             ///< Values are two's complement
+	uint8_t count;                             ///< Number of values: 1, or 3 for multi-axis types
+	uint32_t divisor[LPP_DECODER_MAX_VALUES];  ///< Divisor of every value
+};
+
+/**
+ * @brief Entry of every type byte, NULL for unknown types. Filled from sensor_types before main() runs.
+ */
+extern const LppTypeInfo *lppTypes[256];
+
+/**
+ * @brief Look up a type in the sensor_types table.
+ * @param type LPP type identifier.
+ * @return The entry, or NULL when the type is unknown.
+ */
+static inline const LppTypeInfo *lppFindType(uint8_t type) {
+	return lppTypes[type];
+}
+
+/**
+ * @brief Kind of frame selected by the port of an uplink, like the port dispatch of decodeUplink().
+ */
+enum lpp_frame_t
+{
+	LPP_FRAME_LPP = 0,     ///< Cayenne LPP, on APPLICATION_PORT_CAYENNE and every port without a packed schema
+	LPP_FRAME_PACKED,      ///< Values of a packed schema without channel and type bytes
+	LPP_FRAME_DELTA,       ///< Keyframe or delta frame of LppDeltaEncoder
+	LPP_FRAME_DEADBAND,    ///< Report-by-exception frame of LppDeadbandEncoder
+	LPP_FRAME_KINDS        ///< Number of frame kinds
+};
+
+/**
+ * @brief One field of a packed schema, like an entry of packed_schemas in payload.javascript.
+ */
+struct LppPackedField {
+	uint8_t channel;  ///< Channel of the field
+	uint8_t type;     ///< LPP type identifier
+	uint8_t bits;     ///< Size of a bit-packed scalar, 0 for a value that starts on a byte boundary
+};
+
+/**
+ * @brief Packed schema of KissUplinkSchema.h and the ports it is sent on.
+ */
+struct LppPackedSchema {
+	uint8_t port;                 ///< Port of the packed frames
+	uint8_t delta;                ///< Port of the delta frames, 0 when the schema is not sent delta compressed
+	uint8_t deadband;             ///< Port of the deadband frames, 0 when the schema is not sent by exception
+	uint8_t count;                ///< Number of fields
+	uint8_t values;               ///< Number of values of all fields, LPP_DELTA_MAX_VALUES max
+	const LppPackedField *fields; ///< Fields in the order the encoder writes them
+};
+
+/**
+ * @brief Find the packed schema of a port.
+ * @param port LoRaWAN port of the uplink.
+ * @param frame Kind of the frames on the port, LPP_FRAME_LPP when the port has no packed schema.
+ * @return The schema, or NULL for Cayenne LPP.
+ */
+const LppPackedSchema *lppFindSchema(uint8_t port, lpp_frame_t *frame);
+
+/**
+ * @brief Read a big-endian value and scale it, like arrayToDecimal() in payload.javascript.
+ * Only the low 32 bits are kept, like the JavaScript bit operations.
+ * @param bytes First byte of the value.
+ * @param size Number of bytes.
+ * @param isSigned Sign extend from size bytes.
+ * @param divisor Divisor of the value.
+ * @return The scaled value.
+ */
+double lppReadDecimal(const uint8_t *bytes, uint8_t size, bool isSigned, double divisor);
+
+/**
+ * @brief Read a scalar of 1 to 32 bits and scale it, like bitsToDecimal() in payload.javascript.
+ * @param bytes The frame.
+ * @param offset Bit offset of the scalar, bit 0 is the most significant bit of the first byte.
+ * @param bits Number of bits.
+ * @param isSigned Sign extend from bits bits.
+ * @param divisor Divisor of the value.
+ * @return The scaled value.
+ */
+double lppReadBits(const uint8_t *bytes, size_t offset, uint8_t bits, bool isSigned, double divisor);
+
+/**
+ * @brief Get the size of the value of a field without decoding it, like lppValueSize() in payload.javascript.
+ * @param info Type of the field.
+ * @param bytes First byte after the channel and type.
+ * @param size Number of bytes available, custom types and time series have their size in a header.
+ * @param used Size of the value.
+ * @return LPP_DECODE_OK, LPP_DECODE_TRUNCATED when the header is not complete, or LPP_DECODE_UNKNOWN_TYPE
+ *         for a time series of an unknown type.
+ */
+lpp_decode_result_t lppValueSize(const LppTypeInfo *info, const uint8_t *bytes, size_t size, size_t *used);
+
+/**
+ * @brief Find the value of a field without decoding the frame, to gather values of many frames.
+ * @param bytes The frame.
+ * @param size Size of the frame.
+ * @param channel Channel of the field.
+ * @param type Type of the field.
+ * @return First byte of the value, after the channel and type, or NULL when the frame has no such field.
+ */
+const uint8_t *lppFindValue(const uint8_t *bytes, size_t size, uint8_t channel, uint8_t type);
+
+/**
+ * @brief Time series record (LPP_TIMESERIES), the samples are read on request from the input bytes.
+ */
+struct LppSeries {
+	const LppTypeInfo *type;  ///< Type of the samples
+	uint32_t time;            ///< Time of the first sample in seconds
+	uint16_t interval;        ///< Time between two samples in seconds
+	uint8_t count;            ///< Number of samples
+	const uint8_t *samples;   ///< First byte of the samples
+
+	/**
+	 * @brief Get a sample, scaled by the divisor of its type.
+	 * @param index Sample number, 0 is the oldest.
+	 * @return The scaled sample.
+	 */
+	double sample(uint8_t index) const {
+		return lppReadDecimal(samples + index * type->size, type->size, type->isSigned, type->divisor[0]);
+	}
+};
+
+/**
+ * @brief Decode the value of one field, like lppDecodeValue() in payload.javascript.
+ * @param channel Channel of the field.
+ * @param type Type of the field.
+ * @param bytes First byte after the channel and type.
+ * @param size Number of bytes left in the frame.
+ * @param visitor Receives the field.
+ * @param used Number of bytes the value used.
+ * @return LPP_DECODE_OK, or the reason the field could not be decoded.
+ */
+template <typename Visitor>
+lpp_decode_result_t lppDecodeValue(uint8_t channel, uint8_t type, const uint8_t *bytes, size_t size,
+                                   Visitor &visitor, size_t *used) {
+	const LppTypeInfo *info = lppFindType(type);
+	double values[LPP_DECODER_MAX_VALUES];
+
+	if (!info) {
+		return LPP_DECODE_UNKNOWN_TYPE;
+	}
+
+	switch (info->kind) {
+		case LPP_KIND_BIT:     // addBit, only bit 0 is used
+			if (size < 1) {
+				return LPP_DECODE_TRUNCATED;
+			}
+			values[0] = bytes[0] & 0x01;
+			visitor.onValue(channel, *info, values, 1);
+			*used = 1;
+			break;
+
+		case LPP_KIND_CUSTOM: { // addCustomByte, big-endian (resolution << 3) | size: 13-bit divisor, 3-bit size
+			if (size < 2) {
+				return LPP_DECODE_TRUNCATED;
+			}
+			uint8_t valueSize = bytes[1] & 0x07;
+			uint16_t divisor = ((bytes[0] << 8 | bytes[1]) >> 3) & 0x1FFF;
+			if (size < (size_t)2 + valueSize) {
+				return LPP_DECODE_TRUNCATED;
+			}
+			// Per call locals, the shared type entry is not changed
+			values[0] = lppReadDecimal(bytes + 2, valueSize, info->isSigned, divisor);
+			visitor.onValue(channel, *info, values, 1);
+			*used = 2 + valueSize;
+			break;
+		}
+
+		case LPP_KIND_SERIES: { // Time series
+			if (size < 8) {
+				return LPP_DECODE_TRUNCATED;
+			}
+			LppSeries series;
+			series.type = lppFindType(bytes[0]);
+			if (!series.type) {
+				return LPP_DECODE_UNKNOWN_TYPE;
+			}
+			series.count = bytes[1];
+			series.time = ((uint32_t)bytes[2] << 24) | ((uint32_t)bytes[3] << 16) | ((uint32_t)bytes[4] << 8) | bytes[5];
+			series.interval = (bytes[6] << 8) | bytes[7];
+			series.samples = bytes + 8;
+			if (size < (size_t)8 + series.count * series.type->size) {
+				return LPP_DECODE_TRUNCATED;
+			}
+			visitor.onSeries(channel, series);
+			*used = 8 + series.count * series.type->size;
+			break;
+		}
+
+		default: { // LPP_KIND_VALUES, one value, or count values of size / count bytes each
+			if (size < info->size) {
+				return LPP_DECODE_TRUNCATED;
+			}
+			uint8_t valueSize = info->size / info->count;
+			for (uint8_t n = 0; n < info->count; n++) {
+				values[n] = lppReadDecimal(bytes + n * valueSize, valueSize, info->isSigned, info->divisor[n]);
+			}
+			visitor.onValue(channel, *info, values, info->count);
+			*used = info->size;
+			break;
+		}
+	}
+
+	return LPP_DECODE_OK;
+}
+
+/**
+ * @brief Fixed layout of the start of a frame: the channel and type of every field, and so the offset
+ * of every value, are known in advance.
+ * Most uplinks have the layout of KissUplinkSchema, these are checked with one compare of their
+ * header bytes and decoded without the loop and type dispatch of lppDecodeGeneric().
+ */
+struct LppLayout {
+	uint8_t mask[LPP_LAYOUT_HEADER_SIZE];    ///< 0xFF for the channel and type bytes, 0 for the value bytes
+	uint8_t header[LPP_LAYOUT_HEADER_SIZE];  ///< Channel and type bytes, 0 for the value bytes
+	uint8_t size;                            ///< Size of the fields of the layout, LPP_LAYOUT_HEADER_SIZE at least
+};
+
+/**
+ * @brief Check whether a frame starts with the channel and type bytes of a layout.
+ * @param bytes The frame, LPP_LAYOUT_HEADER_SIZE bytes at least.
+ * @param layout The layout.
+ * @return true when all channel and type bytes match.
+ */
+static inline bool lppMatchLayout(const uint8_t *bytes, const LppLayout &layout) {
+	uint64_t differ = 0;
+
+	// Compared a word at a time and without branches, the compiler turns this into vector compares
+	for (size_t w = 0; w < LPP_LAYOUT_HEADER_SIZE; w += sizeof(uint64_t)) {
+		uint64_t frame, mask, header;
+		memcpy(&frame, bytes + w, sizeof(frame));
+		memcpy(&mask, layout.mask + w, sizeof(mask));
+		memcpy(&header, layout.header + w, sizeof(header));
+		differ |= (frame ^ header) & mask;
+	}
+	return differ == 0;
+}
+
+// Generated by host/schema/lpp_schema.js from lpp_schema.json, do not edit
+// Fixed layouts of the schemas of KissUplinkSchema.h, sent as regular LPP
+
+/// KissUplinkSchema: Layout of the regular uplink, one field per sensor in the order they are sent.
+static const LppLayout lppKissUplinkSchemaLayout = {
+	{0xFF, 0xFF, 0, 0, 0xFF, 0xFF, 0, 0xFF, 0xFF, 0, 0, 0xFF, 0xFF, 0, 0xFF, 0xFF,
+	 0, 0, 0, 0, 0, 0, 0xFF, 0xFF, 0, 0, 0xFF, 0xFF, 0, 0xFF, 0xFF, 0},
+	{0, 103, 0, 0, 1, 104, 0, 2, 101, 0, 0, 3, 0, 0, 4, 113,
+	 0, 0, 0, 0, 0, 0, 5, 2, 0, 0, 6, 102, 0, 20, 3, 0},
+	33
+};
+
+/**
+ * @brief Decode the fields of lppKissUplinkSchemaLayout, every value is at a fixed offset.
+ */
+template <typename Visitor>
+static inline void lppExtractKissUplinkSchema(const uint8_t *bytes, Visitor &visitor) {
+	double values[LPP_DECODER_MAX_VALUES];
+
+	// temperature, LPP_CH_TEMPERATURE and LPP_TEMPERATURE
+	values[0] = (int16_t)((bytes[2] << 8) | bytes[3]) / 10.0;
+	visitor.onValue(0, *lppTypes[103], values, 1);
+
+	// humidity, LPP_CH_HUMIDITY and LPP_RELATIVE_HUMIDITY
+	values[0] = bytes[6] / 2.0;
+	visitor.onValue(1, *lppTypes[104], values, 1);
+
+	// illuminance, LPP_CH_LUMINOSITY and LPP_LUMINOSITY
+	values[0] = (uint16_t)((bytes[9] << 8) | bytes[10]);
+	visitor.onValue(2, *lppTypes[101], values, 1);
+
+	// rotary switch, LPP_CH_ROTARYSWITCH and LPP_DIGITAL_INPUT
+	values[0] = bytes[13];
+	visitor.onValue(3, *lppTypes[0], values, 1);
+
+	// accelerometer, LPP_CH_ACCELEROMETER and LPP_ACCELEROMETER
+	values[0] = (int16_t)((bytes[16] << 8) | bytes[17]) / 1000.0;
+	values[1] = (int16_t)((bytes[18] << 8) | bytes[19]) / 1000.0;
+	values[2] = (int16_t)((bytes[20] << 8) | bytes[21]) / 1000.0;
+	visitor.onValue(4, *lppTypes[113], values, 3);
+
+	// VDD, LPP_CH_BOARDVCCVOLTAGE and LPP_ANALOG_INPUT
+	values[0] = (int16_t)((bytes[24] << 8) | bytes[25]) / 100.0;
+	visitor.onValue(5, *lppTypes[2], values, 1);
+
+	// presence, LPP_CH_PRESENCE and LPP_PRESENCE
+	values[0] = bytes[28];
+	visitor.onValue(6, *lppTypes[102], values, 1);
+
+	// interval, LPP_CH_SET_INTERVAL and LPP_ANALOG_OUTPUT
+	values[0] = (int16_t)((bytes[31] << 8) | bytes[32]) / 100.0;
+	visitor.onValue(20, *lppTypes[3], values, 1);
+}
+
+/**
+ * @brief Decode the fields of a fixed layout at the start of a frame.
+ * @param bytes The frame.
+ * @param size Size of the frame.
+ * @param visitor Receives the fields of the layout.
+ * @return Size of the layout, or 0 when the frame does not start with a fixed layout.
+ */
+template <typename Visitor>
+static inline size_t lppDecodeLayouts(const uint8_t *bytes, size_t size, Visitor &visitor) {
+	if (size >= lppKissUplinkSchemaLayout.size && lppMatchLayout(bytes, lppKissUplinkSchemaLayout)) {
+		lppExtractKissUplinkSchema(bytes, visitor);
+		return lppKissUplinkSchemaLayout.size;
+	}
+	return 0;
+}
+// End of generated code
+
+/**
+ * @brief Decode a Cayenne LPP frame field by field, like lppDecode() in payload.javascript.
+ * @param bytes The frame.
+ * @param size Size of the frame.
+ * @param visitor Receives every field in frame order.
+ * @return LPP_DECODE_OK, or the reason decoding stopped.
+ */
+template <typename Visitor>
+lpp_decode_result_t lppDecodeGeneric(const uint8_t *bytes, size_t size, Visitor &visitor) {
+	size_t i = 0;
+
+	while (i < size) {
+		size_t used;
+
+		if ((size - i) < 2) {
+			return LPP_DECODE_TRUNCATED;
+		}
+		lpp_decode_result_t result = lppDecodeValue(bytes[i], bytes[i + 1], bytes + i + 2, size - i - 2, visitor, &used);
+		if (result != LPP_DECODE_OK) {
+			return result;
+		}
+		i += 2 + used;
+	}
+
+	return LPP_DECODE_OK;
+}
+
+/**
+ * @brief Decode a Cayenne LPP frame, like lppDecode() in payload.javascript.
+ * A frame that starts with a fixed layout, such as KissUplinkSchema, has those fields decoded at
+ * their fixed offsets, the fields after them and all other frames go through lppDecodeGeneric().
+ * @param bytes The frame.
+ * @param size Size of the frame.
+ * @param visitor Receives every field in frame order.
+ * @return LPP_DECODE_OK, or the reason decoding stopped.
+ */
+template <typename Visitor>
+lpp_decode_result_t lppDecode(const uint8_t *bytes, size_t size, Visitor &visitor) {
+	size_t known = lppDecodeLayouts(bytes, size, visitor);
+
+	return lppDecodeGeneric(bytes + known, size - known, visitor);
+}
+
+/**
+ * @brief Decode a packed frame, like lppDecodePacked() in payload.javascript.
+ * Fields with bits are read at bit granularity, all other fields start on a byte boundary.
+ * @param schema The packed schema of the frame.
+ * @param bytes The frame.
+ * @param size Size of the frame.
+ * @param visitor Receives every field of the schema.
+ * @param used Number of bytes of the packed part, any bytes after that are regular LPP.
+ * @return LPP_DECODE_OK, or the reason decoding stopped.
+ */
+template <typename Visitor>
+lpp_decode_result_t lppDecodePacked(const LppPackedSchema &schema, const uint8_t *bytes, size_t size,
+                                    Visitor &visitor, size_t *used) {
+	double values[LPP_DECODER_MAX_VALUES];
+	size_t bit = 0;
+
+	for (uint8_t f = 0; f < schema.count; f++) {
+		const LppPackedField &field = schema.fields[f];
+		const LppTypeInfo *info = lppFindType(field.type);
+
+		if (field.bits) {
+			if (bit + field.bits > size * 8) {
+				return LPP_DECODE_TRUNCATED;
+			}
+			values[0] = lppReadBits(bytes, bit, field.bits, info->isSigned, info->divisor[0]);
+			visitor.onValue(field.channel, *info, values, 1);
+			bit += field.bits;
+		} else {
+			size_t i = (bit + 7) >> 3;
+			size_t length;
+			lpp_decode_result_t result = lppDecodeValue(field.channel, field.type, bytes + i, size - i, visitor, &length);
+			if (result != LPP_DECODE_OK) {
+				return result;
+			}
+			bit = (i + length) * 8;
+		}
+	}
+
+	*used = (bit + 7) >> 3;
+	return LPP_DECODE_OK;
+}
+
+/**
+ * @brief Read the zigzag varints of count values, as LppDeltaEncoder and LppDeadbandEncoder write them.
+ * @return Number of bytes read, or 0 when a varint is truncated.
+ */
+static inline size_t lppReadVarints(const uint8_t *bytes, size_t size, int32_t *values, uint8_t count) {
+	size_t i = 0;
+
+	for (uint8_t n = 0; n < count; n++) {
+		uint8_t length = lppReadVarint(bytes + i, (size - i) > 0xFF ? 0xFF : (uint8_t)(size - i), &values[n]);
+		if (length == 0) {
+			return 0;
+		}
+		i += length;
+	}
+	return i;
+}
+
+/**
+ * @brief Scale the varints of one field, like lppScaleValues() in payload.javascript.
+ */
+static inline void lppScaleVarints(const LppTypeInfo &info, const int32_t *ints, double *values) {
+	for (uint8_t v = 0; v < info.count; v++) {
+		values[v] = ints[v] / (double)info.divisor[v];
+	}
+}
+
+/**
+ * @brief Decode a keyframe or delta frame without device state, like lppDecodeDelta() in payload.javascript.
+ * The values of a keyframe go to onValue(), those of a delta frame are the differences with its keyframe
+ * and go to onDelta(). LppDeviceCache turns delta frames into absolute values.
+ * @param schema The packed schema of the frame.
+ * @param bytes The frame.
+ * @param size Size of the frame.
+ * @param visitor Receives every field of the schema.
+ * @param used Number of bytes of the delta part, any bytes after that are regular LPP.
+ * @return LPP_DECODE_OK, or LPP_DECODE_TRUNCATED.
+ */
+template <typename Visitor>
+lpp_decode_result_t lppDecodeDelta(const LppPackedSchema &schema, const uint8_t *bytes, size_t size,
+                                   Visitor &visitor, size_t *used) {
+	int32_t ints[LPP_DELTA_MAX_VALUES];
+	double values[LPP_DECODER_MAX_VALUES];
+
+	if (size < LPP_DELTA_HEADER_SIZE) {
+		return LPP_DECODE_TRUNCATED;
+	}
+	size_t length = lppReadVarints(bytes + LPP_DELTA_HEADER_SIZE, size - LPP_DELTA_HEADER_SIZE, ints, schema.values);
+	if (length == 0 && schema.values > 0) {
+		return LPP_DECODE_TRUNCATED;
+	}
+
+	bool keyframe = bytes[0] & LPP_DELTA_KEYFRAME;
+	const int32_t *next = ints;
+	for (uint8_t f = 0; f < schema.count; f++) {
+		const LppTypeInfo *info = lppFindType(schema.fields[f].type);
+		lppScaleVarints(*info, next, values);
+		if (keyframe) {
+			visitor.onValue(schema.fields[f].channel, *info, values, info->count);
+		} else {
+			visitor.onDelta(schema.fields[f].channel, *info, values, info->count);
+		}
+		next += info->count;
+	}
+
+	*used = LPP_DELTA_HEADER_SIZE + length;
+	return LPP_DECODE_OK;
+}
+
+/**
+ * @brief Decode a report-by-exception frame without device state, like lppDecodeDeadband() in payload.javascript.
+ * A bitmap tells which fields are in the frame, the fields that were left out are not reported.
+ * @param schema The packed schema of the frame.
+ * @param bytes The frame.
+ * @param size Size of the frame.
+ * @param visitor Receives the fields in the frame.
+ * @param used Number of bytes of the deadband part, any bytes after that are regular LPP.
+ * @return LPP_DECODE_OK, or LPP_DECODE_TRUNCATED.
+ */
+template <typename Visitor>
+lpp_decode_result_t lppDecodeDeadband(const LppPackedSchema &schema, const uint8_t *bytes, size_t size,
+                                      Visitor &visitor, size_t *used) {
+	int32_t ints[LPP_DECODER_MAX_VALUES];
+	double values[LPP_DECODER_MAX_VALUES];
+	size_t i = (schema.count + 7) >> 3;
+
+	if (size < i) {
+		return LPP_DECODE_TRUNCATED;
+	}
+	for (uint8_t f = 0; f < schema.count; f++) {
+		if (!(bytes[f >> 3] & (0x80 >> (f & 0x07)))) {
+			continue;
+		}
+		const LppTypeInfo *info = lppFindType(schema.fields[f].type);
+		size_t length = lppReadVarints(bytes + i, size - i, ints, info->count);
+		if (length == 0) {
+			return LPP_DECODE_TRUNCATED;
+		}
+		lppScaleVarints(*info, ints, values);
+		visitor.onValue(schema.fields[f].channel, *info, values, info->count);
+		i += length;
+	}
+
+	*used = i;
+	return LPP_DECODE_OK;
+}
+
+/**
+ * @brief Decode an uplink by its port, like decodeUplink() in payload.javascript.
+ * Packed, delta and deadband frames are decoded with the packed schema of their port. The bytes after
+ * them, and the frames on all other ports, are decoded as Cayenne LPP.
+ * @param port LoRaWAN port of the uplink.
+ * @param bytes The frame.
+ * @param size Size of the frame.
+ * @param visitor Receives every field in frame order, needs onDelta() as well.
+ * @return LPP_DECODE_OK, or the reason decoding stopped.
+ */
+template <typename Visitor>
+lpp_decode_result_t lppDecodeUplink(uint8_t port, const uint8_t *bytes, size_t size, Visitor &visitor) {
+	lpp_frame_t frame;
+	const LppPackedSchema *schema = lppFindSchema(port, &frame);
+	lpp_decode_result_t result = LPP_DECODE_OK;
+	size_t used = 0;
+
+	switch (frame) {
+		case LPP_FRAME_PACKED:
+			result = lppDecodePacked(*schema, bytes, size, visitor, &used);
+			break;
+		case LPP_FRAME_DELTA:
+			result = lppDecodeDelta(*schema, bytes, size, visitor, &used);
+			break;
+		case LPP_FRAME_DEADBAND:
+			result = lppDecodeDeadband(*schema, bytes, size, visitor, &used);
+			break;
+		default:
+			break;
+	}
+	if (result != LPP_DECODE_OK) {
+		return result;
+	}
+	// Anything after the packed, delta or deadband part is regular LPP, such as a time series
+	return lppDecode(bytes + used, size - used, visitor);
+}
+
+#endif
@@ -0,0 +1,326 @@
+#include "LppDeviceCache.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <new>
+#include <string>
+
+/**
+ * @brief Header of a snapshot file, followed by the keys and the states of all slots.
+ */
+struct LppDeviceSnapshot {
+	char magic[8];        ///< "LPPDEVC"
+	uint32_t version;     ///< LPP_DEVICE_SNAPSHOT_VERSION
+	uint32_t stateSize;   ///< sizeof(LppDeviceState) of the writer
+	uint64_t capacity;    ///< Number of slots
+	uint64_t used;        ///< Number of devices
+};
+
+static const char snapshotMagic[8] = "LPPDEVC";
+
+/**
+ * @brief Round up to a power of 2, LPP_DEVICE_MIN_CAPACITY at least.
+ */
+static size_t powerOfTwo(size_t n) {
+	size_t p = LPP_DEVICE_MIN_CAPACITY;
+	while (p < n) {
+		p <<= 1;
+	}
+	return p;
+}
+
+/**
+ * @brief Size of a table or snapshot file of slots slots.
+ */
+static size_t snapshotSize(size_t slots) {
+	return sizeof(LppDeviceSnapshot) + slots * (sizeof(uint64_t) + sizeof(LppDeviceState));
+}
+
+/**
+ * @brief Map an empty table of slots slots, all keys are LPP_DEVICE_NONE.
+ * @return The mapping, throws std::bad_alloc like a vector when there is no memory.
+ */
+static uint8_t *mapTable(size_t slots) {
+	// Anonymous mappings are zero filled, which is LPP_DEVICE_NONE for every key
+	void *mapping = mmap(NULL, snapshotSize(slots), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mapping == MAP_FAILED) {
+		throw std::bad_alloc();
+	}
+	return (uint8_t *)mapping;
+}
+
+LppDeviceCache::LppDeviceCache(size_t capacity) : table(NULL), tableSize(0) {
+	// At most 7/8 of the slots are used, the keys are scanned without touching the states
+	size_t slots = powerOfTwo(capacity + capacity / 7 + 1);
+
+	adopt(mapTable(slots), slots);
+	used = 0;
+}
+
+LppDeviceCache::~LppDeviceCache() {
+	munmap(table, tableSize);
+}
+
+/**
+ * @brief Replace the table with a mapping of slots slots, laid out like a snapshot file.
+ */
+void LppDeviceCache::adopt(uint8_t *mapping, size_t slots) {
+	if (table) {
+		munmap(table, tableSize);
+	}
+	table = mapping;
+	tableSize = snapshotSize(slots);
+	keys = (uint64_t *)(table + sizeof(LppDeviceSnapshot));
+	states = (LppDeviceState *)(keys + slots);
+	mask = slots - 1;
+}
+
+size_t LppDeviceCache::slot(uint64_t devEui) const {
+	// DevEUIs of one vendor share the upper 24 bits, so mix all bits into the index (splitmix64)
+	devEui ^= devEui >> 30;
+	devEui *= 0xBF58476D1CE4E5B9ULL;
+	devEui ^= devEui >> 27;
+	devEui *= 0x94D049BB133111EBULL;
+	devEui ^= devEui >> 31;
+	return (size_t)devEui & mask;
+}
+
+LppDeviceState *LppDeviceCache::find(uint64_t devEui) {
+	if (devEui == LPP_DEVICE_NONE) {
+		return NULL;
+	}
+	for (size_t i = slot(devEui);; i = (i + 1) & mask) {
+		if (keys[i] == devEui) {
+			return &states[i];
+		}
+		if (keys[i] == LPP_DEVICE_NONE) {
+			return NULL;
+		}
+	}
+}
+
+LppDeviceState *LppDeviceCache::insert(uint64_t devEui, uint8_t schema, uint8_t count) {
+	if (devEui == LPP_DEVICE_NONE || schema > LPP_DEVICE_MAX_SCHEMA) {
+		return NULL;
+	}
+	if (count > LPP_DELTA_MAX_VALUES) {
+		count = LPP_DELTA_MAX_VALUES;
+	}
+
+	size_t i = slot(devEui);
+	while (keys[i] != devEui && keys[i] != LPP_DEVICE_NONE) {
+		i = (i + 1) & mask;
+	}
+
+	if (keys[i] == LPP_DEVICE_NONE) {
+		if (8 * (used + 1) > 7 * (mask + 1)) {
+			grow();
+			return insert(devEui, schema, count);
+		}
+		keys[i] = devEui;
+		used++;
+	} else if (states[i].schema == schema && states[i].count == count) {
+		return &states[i];
+	}
+
+	memset(&states[i], 0, sizeof(LppDeviceState));
+	states[i].schema = schema;
+	states[i].count = count;
+	return &states[i];
+}
+
+bool LppDeviceCache::erase(uint64_t devEui) {
+	if (devEui == LPP_DEVICE_NONE) {
+		return false;
+	}
+
+	size_t i = slot(devEui);
+	while (keys[i] != devEui) {
+		if (keys[i] == LPP_DEVICE_NONE) {
+			return false;
+		}
+		i = (i + 1) & mask;
+	}
+
+	// Move back the devices after the hole that cannot be found anymore, so no tombstones are needed
+	for (size_t j = (i + 1) & mask; keys[j] != LPP_DEVICE_NONE; j = (j + 1) & mask) {
+		size_t home = slot(keys[j]);
+		if (((j - home) & mask) >= ((j - i) & mask)) {
+			keys[i] = keys[j];
+			states[i] = states[j];
+			i = j;
+		}
+	}
+	keys[i] = LPP_DEVICE_NONE;
+	used--;
+	return true;
+}
+
+void LppDeviceCache::grow(void) {
+	size_t oldSlots = mask + 1;
+	uint8_t *oldTable = table;
+	const uint64_t *oldKeys = keys;
+	const LppDeviceState *oldStates = states;
+
+	// Map an empty table of twice the size, then add the devices again
+	table = NULL;
+	adopt(mapTable(2 * oldSlots), 2 * oldSlots);
+
+	for (size_t n = 0; n < oldSlots; n++) {
+		if (oldKeys[n] != LPP_DEVICE_NONE) {
+			size_t i = slot(oldKeys[n]);
+			while (keys[i] != LPP_DEVICE_NONE) {
+				i = (i + 1) & mask;
+			}
+			keys[i] = oldKeys[n];
+			states[i] = oldStates[n];
+		}
+	}
+	munmap(oldTable, snapshotSize(oldSlots));
+}
+
+lpp_delta_result_t LppDeviceCache::decodeDelta(uint64_t devEui, uint8_t schema, uint8_t count, const uint8_t *frame,
+                                               uint8_t size, int32_t *values) {
+	LppDeviceState *state = insert(devEui, schema, count);
+
+	if (!state || size < LPP_DELTA_HEADER_SIZE) {
+		return LPP_DELTA_INVALID;
+	}
+
+	bool isKeyframe = frame[0] & LPP_DELTA_KEYFRAME;
+	uint8_t id = frame[0] & LPP_DELTA_ID_MASK;
+	uint8_t cursor = LPP_DELTA_HEADER_SIZE;
+
+	state->lostFrames = (state->flags & LPP_DEVICE_COUNTER) ? (uint8_t)(frame[1] - state->counter - 1) : 0;
+	state->counter = frame[1];
+	state->flags |= LPP_DEVICE_COUNTER;
+
+	if (!isKeyframe && (!(state->flags & LPP_DEVICE_KEYFRAME) || id != state->keyframeId)) {
+		return LPP_DELTA_RESYNC;
+	}
+
+	for (uint8_t i = 0; i < state->count; i++) {
+		int32_t value;
+		uint8_t length = lppReadVarint(frame + cursor, size - cursor, &value);
+
+		if (length == 0) {
+			return LPP_DELTA_INVALID;
+		}
+		values[i] = isKeyframe ? value : (int32_t)((uint32_t)state->keyframe[i] + (uint32_t)value);
+		cursor += length;
+	}
+
+	if (isKeyframe) {
+		memcpy(state->keyframe, values, state->count * sizeof(int32_t));
+		state->keyframeId = id;
+		state->flags |= LPP_DEVICE_KEYFRAME;
+	}
+
+	return LPP_DELTA_OK;
+}
+
+size_t LppDeviceCache::size(void) const {
+	return used;
+}
+
+size_t LppDeviceCache::capacity(void) const {
+	return mask + 1;
+}
+
+bool LppDeviceCache::snapshot(const char *path) const {
+	std::string temporary = std::string(path) + ".tmp";
+	size_t fileSize = tableSize;
+
+	int fd = open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		return false;
+	}
+	if (ftruncate(fd, fileSize) != 0) {
+		close(fd);
+		unlink(temporary.c_str());
+		return false;
+	}
+	uint8_t *file = (uint8_t *)mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (file == MAP_FAILED) {
+		close(fd);
+		unlink(temporary.c_str());
+		return false;
+	}
+
+	LppDeviceSnapshot header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, snapshotMagic, sizeof(header.magic));
+	header.version = LPP_DEVICE_SNAPSHOT_VERSION;
+	header.stateSize = sizeof(LppDeviceState);
+	header.capacity = mask + 1;
+	header.used = used;
+	memcpy(file, &header, sizeof(header));
+	memcpy(file + sizeof(header), table + sizeof(header), tableSize - sizeof(header));
+
+	bool written = msync(file, fileSize, MS_SYNC) == 0;
+	munmap(file, fileSize);
+	written = fsync(fd) == 0 && written;
+	close(fd);
+	if (!written || rename(temporary.c_str(), path) != 0) {
+		unlink(temporary.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool LppDeviceCache::restore(const char *path) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(LppDeviceSnapshot)) {
+		close(fd);
+		return false;
+	}
+	// Private and writable: pages are copied when a device changes, the file is never written
+	size_t fileSize = info.st_size;
+	uint8_t *file = (uint8_t *)mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (file == MAP_FAILED) {
+		return false;
+	}
+
+	// Check the header before trusting any size in it
+	LppDeviceSnapshot header;
+	memcpy(&header, file, sizeof(header));
+	size_t slots = header.capacity;
+	bool valid = memcmp(header.magic, snapshotMagic, sizeof(header.magic)) == 0 &&
+	             header.version == LPP_DEVICE_SNAPSHOT_VERSION && header.stateSize == sizeof(LppDeviceState) &&
+	             slots >= LPP_DEVICE_MIN_CAPACITY && (slots & (slots - 1)) == 0 && header.used < slots &&
+	             slots <= fileSize / (sizeof(uint64_t) + sizeof(LppDeviceState)) &&
+	             fileSize == snapshotSize(slots);
+
+	const uint64_t *fileKeys = (const uint64_t *)(file + sizeof(header));
+	const LppDeviceState *fileStates = (const LppDeviceState *)(fileKeys + slots);
+	if (valid) {
+		// A table without empty slot would make find() loop forever, and a count above
+		// LPP_DELTA_MAX_VALUES would make decodeDelta() run past the keyframe
+		size_t devices = 0;
+		for (size_t n = 0; valid && n < slots; n++) {
+			if (fileKeys[n] != LPP_DEVICE_NONE) {
+				devices++;
+				valid = fileStates[n].count <= LPP_DELTA_MAX_VALUES && fileStates[n].schema <= LPP_DEVICE_MAX_SCHEMA;
+			}
+		}
+		valid = valid && devices == header.used;
+	}
+
+	if (!valid) {
+		munmap(file, fileSize);
+		return false;
+	}
+	adopt(file, slots);
+	used = header.used;
+	return true;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file  LppDeviceCache.h
+ * @brief Per-device decoder state for server-side ingest of packed and delta uplinks, keyed by DevEUI.
+ * @note  Decodes the frames of LppDeltaEncoder in LoRa_TX_RX_Cayenne_HAN, see LppDelta.h.
+ * @copyright (c) 2024, Leon Nguyen and Len Verploegen
+ *
+ * The MIT License (MIT), see CustomCayeneLPP.h.
+ *
+ * A delta frame can only be decoded with the last keyframe of the device that sent it. The cache keeps
+ * one fixed size LppDeviceState per device in an open addressing table with linear probing. The DevEUIs
+ * are in an array of their own, so a lookup scans a few adjacent keys and touches one state.
+ *
+ * snapshot() writes the table to a file and restore() maps it back in, so after a restart of the service
+ * the devices do not all have to be asked for a new keyframe. The file is in the byte order of the host.
+ * The table is kept in a mapping laid out like the file: an anonymous one, or after restore() a private
+ * mapping of the file itself, so only the pages of devices that send frames are read and copied.
+ *
+ * @author  Leon Nguyen and Len Verpleogen
+ */
+#ifndef _LPPDEVICECACHE_H_
+#define _LPPDEVICECACHE_H_
+
+#include "LppDelta.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LPP_DEVICE_NONE 0ULL               /// \ DevEUI of an empty slot, the all-zero EUI-64 is never assigned
+#define LPP_DEVICE_KEYFRAME 0x01           /// \ Flag of LppDeviceState: a keyframe was received
+#define LPP_DEVICE_COUNTER 0x02            /// \ Flag of LppDeviceState: a frame was received
+#define LPP_DEVICE_MIN_CAPACITY 16         /// \ Minimum number of slots of the table
+#define LPP_DEVICE_MAX_SCHEMA 223          /// \ Highest LoRaWAN application port, the ports above are reserved
+#define LPP_DEVICE_SNAPSHOT_VERSION 1      /// \ Version of the snapshot file, increment when LppDeviceState changes
+
+/**
+ * @brief Decoder state of one device, the same as LppDeltaDecoder keeps.
+ */
+struct LppDeviceState {
+	int32_t keyframe[LPP_DELTA_MAX_VALUES];  ///< Values of the last keyframe
+	uint8_t schema;                          ///< Port of the packed schema of the frames, 0 when not known
+	uint8_t count;                           ///< Number of values in every frame
+	uint8_t keyframeId;                      ///< Id of the last keyframe
+	uint8_t counter;                         ///< Counter of the last frame
+	uint8_t lostFrames;                      ///< Frames lost before the last frame
+	uint8_t flags;                           ///< LPP_DEVICE_KEYFRAME and LPP_DEVICE_COUNTER
+	uint8_t reserved[2];                     ///< Padding, zero
+};
+
+/**
+ * @brief Open addressing table of LppDeviceState keyed by DevEUI.
+ */
+class LppDeviceCache {
+public:
+	/**
+	 * @brief Constructor for LppDeviceCache class.
+	 * @param capacity Expected number of devices, the table grows when more are added.
+	 */
+	LppDeviceCache(size_t capacity = 1024);
+	~LppDeviceCache();
+
+	LppDeviceCache(const LppDeviceCache &) = delete;
+	LppDeviceCache &operator=(const LppDeviceCache &) = delete;
+
+	/**
+	 * @brief Find the state of a device.
+	 * @param devEui DevEUI of the device.
+	 * @return The state, or NULL when the device is not in the cache.
+	 */
+	LppDeviceState *find(uint64_t devEui);
+
+	/**
+	 * @brief Find the state of a device, add it when it is not in the cache.
+	 * A device that changed to another schema or number of values starts again without keyframe.
+	 * The pointer is valid until the next insert(), erase() or restore().
+	 * @param devEui DevEUI of the device, not LPP_DEVICE_NONE.
+	 * @param schema Port of the packed schema of the frames (LPP_DEVICE_MAX_SCHEMA max).
+	 * @param count Number of values in every frame (LPP_DELTA_MAX_VALUES max).
+	 * @return The state, or NULL for LPP_DEVICE_NONE or a schema above LPP_DEVICE_MAX_SCHEMA.
+	 */
+	LppDeviceState *insert(uint64_t devEui, uint8_t schema, uint8_t count);
+
+	/**
+	 * @brief Remove a device.
+	 * @param devEui DevEUI of the device.
+	 * @return true when the device was in the cache.
+	 */
+	bool erase(uint64_t devEui);
+
+	/**
+	 * @brief Decode a frame of LppDeltaEncoder with the state of the device, like LppDeltaDecoder::decode().
+	 * @param devEui DevEUI of the device that sent the frame.
+	 * @param schema Port of the packed schema of the frame.
+	 * @param count Number of values in the frame.
+	 * @param frame The received frame.
+	 * @param size Size of the frame.
+	 * @param values Array of count values the result is written into.
+	 * @return LPP_DELTA_OK, or the reason the values could not be decoded.
+	 */
+	lpp_delta_result_t decodeDelta(uint64_t devEui, uint8_t schema, uint8_t count, const uint8_t *frame, uint8_t size,
+	                               int32_t *values);
+
+	/**
+	 * @brief Get the number of devices in the cache.
+	 */
+	size_t size(void) const;
+
+	/**
+	 * @brief Get the number of slots of the table.
+	 */
+	size_t capacity(void) const;
+
+	/**
+	 * @brief Write all devices to a file, through a temporary file so a crash leaves the old snapshot.
+	 * @param path Name of the file.
+	 * @return true when the snapshot was written.
+	 */
+	bool snapshot(const char *path) const;
+
+	/**
+	 * @brief Replace all devices with the ones of a snapshot, served from a private mapping of the file.
+	 * Changes are not written back, and the file must not be changed in place while it is mapped.
+	 * snapshot() writes a new file and renames it, so it can be called with the same path.
+	 * @param path Name of a file written by snapshot().
+	 * @return true when the snapshot was valid, the cache is not changed otherwise.
+	 */
+	bool restore(const char *path);
+
+private:
+	uint8_t *table;          ///< Mapping of the header, keys and states, laid out like a snapshot file
+	size_t tableSize;        ///< Size of the mapping in bytes
+	uint64_t *keys;          ///< DevEUI of every slot, LPP_DEVICE_NONE when empty
+	LppDeviceState *states;  ///< State of every slot
+	size_t used;             ///< Number of devices
+	size_t mask;             ///< Number of slots - 1, the number of slots is a power of 2
+
+	size_t slot(uint64_t devEui) const;
+	void grow(void);
+	void adopt(uint8_t *mapping, size_t slots);
+};
+
+#endif
@@ -0,0 +1,169 @@
+/**
+ * @file  LppStreamDecoder.h
+ * @brief Incremental decoder for Cayenne LPP bytes that arrive in chunks of any size.
+ * @note  Mirrors lppDecodeStream() and lppEndStream() in payload.javascript.
+ * @copyright (c) 2024, Leon Nguyen and Len Verploegen
+ *
+ * The MIT License (MIT), see CustomCayeneLPP.h.
+ *
+ * lppDecode() needs the whole frame. LppStreamDecoder takes the bytes as they arrive, for example from a
+ * gateway bridge or the frames of a payload that was split over several uplinks, and reports every field
+ * to the visitor (see LppDecoder.h) as soon as its last byte arrived. Only the bytes of the one field
+ * that is not complete yet are kept between chunks.
+ *
+ * An unknown type stops the decoder, the chunks after it are ignored until reset(). finish() reports a
+ * field that was not complete at the end of the stream.
+ *
+ * @author  Leon Nguyen and Len Verpleogen
+ */
+#ifndef _LPPSTREAMDECODER_H_
+#define _LPPSTREAMDECODER_H_
+
+#include "LppDecoder.h"
+
+#include <string.h>
+
+#define LPP_STREAM_MAX_FIELD_SIZE (2 + 8 + 255 * 9)  /// \ Largest field: time series of 255 GPS samples
+
+/**
+ * @brief Resumable decoder state, one per stream.
+ */
+class LppStreamDecoder {
+public:
+	/**
+	 * @brief Constructor for LppStreamDecoder class.
+	 */
+	LppStreamDecoder() {
+		reset();
+	}
+
+	/**
+	 * @brief Start a new stream, the kept bytes and the error are discarded.
+	 */
+	void reset(void) {
+		buffered = 0;
+		error = LPP_DECODE_OK;
+	}
+
+	/**
+	 * @brief Decode the next chunk of the stream.
+	 * The samples of an LppSeries are only valid during onSeries().
+	 * @param bytes The chunk.
+	 * @param size Size of the chunk.
+	 * @param visitor Receives every field that is complete, in stream order.
+	 * @return LPP_DECODE_OK, or the error that stopped the decoder: LPP_DECODE_UNKNOWN_TYPE, or
+	 *         LPP_DECODE_TRUNCATED for a field larger than LPP_STREAM_MAX_FIELD_SIZE.
+	 */
+	template <typename Visitor>
+	lpp_decode_result_t feed(const uint8_t *bytes, size_t size, Visitor &visitor) {
+		size_t i = 0;
+
+		if (error != LPP_DECODE_OK) {
+			return error;
+		}
+
+		// Complete the field that the previous chunks ended in
+		while (buffered > 0 && i < size) {
+			size_t need = 0;
+			lpp_decode_result_t result = buffered < 2 ? LPP_DECODE_TRUNCATED : fieldSize(buffer, buffered, &need);
+
+			if (result == LPP_DECODE_UNKNOWN_TYPE || need > LPP_STREAM_MAX_FIELD_SIZE) {
+				return error = result == LPP_DECODE_UNKNOWN_TYPE ? result : LPP_DECODE_TRUNCATED;
+			}
+			if (result == LPP_DECODE_TRUNCATED) {
+				// Channel and type, or the header of a custom type or time series, not complete: take one byte at a time
+				buffer[buffered++] = bytes[i++];
+				continue;
+			}
+			size_t take = need - buffered < size - i ? need - buffered : size - i;
+			memcpy(buffer + buffered, bytes + i, take);
+			buffered += take;
+			i += take;
+			if (buffered == need) {
+				size_t used;
+				lppDecodeValue(buffer[0], buffer[1], buffer + 2, need - 2, visitor, &used);
+				buffered = 0;
+			}
+		}
+
+		// Then the fields that are complete in this chunk, straight from the chunk
+		while (size - i >= 2) {
+			size_t used;
+			lpp_decode_result_t result = lppDecodeValue(bytes[i], bytes[i + 1], bytes + i + 2, size - i - 2, visitor, &used);
+
+			if (result == LPP_DECODE_UNKNOWN_TYPE) {
+				return error = result;
+			}
+			if (result == LPP_DECODE_TRUNCATED) {
+				break;
+			}
+			i += 2 + used;
+		}
+
+		// Keep the start of the last field for the next chunk
+		if (i < size) {
+			if (size - i > LPP_STREAM_MAX_FIELD_SIZE) {
+				return error = LPP_DECODE_TRUNCATED;
+			}
+			memcpy(buffer, bytes + i, size - i);
+			buffered = size - i;
+		}
+
+		return LPP_DECODE_OK;
+	}
+
+	/**
+	 * @brief End the stream, the decoder can be used for a new stream after this.
+	 * @param channel Channel of the field that was not complete, when the header arrived.
+	 * @param type Type of the field that was not complete, when the header arrived.
+	 * @return LPP_DECODE_OK, LPP_DECODE_TRUNCATED when the stream ended inside a field,
+	 *         or the error that stopped the decoder.
+	 */
+	lpp_decode_result_t finish(uint8_t *channel = NULL, uint8_t *type = NULL) {
+		lpp_decode_result_t result = error;
+
+		if (result == LPP_DECODE_OK && buffered > 0) {
+			result = LPP_DECODE_TRUNCATED;
+			if (channel) {
+				*channel = buffer[0];
+			}
+			if (type && buffered >= 2) {
+				*type = buffer[1];
+			}
+		}
+		reset();
+		return result;
+	}
+
+	/**
+	 * @brief Get the number of bytes kept of the field that is not complete yet.
+	 */
+	size_t pending(void) const {
+		return buffered;
+	}
+
+private:
+	uint8_t buffer[LPP_STREAM_MAX_FIELD_SIZE];  ///< Start of the field that is not complete yet
+	size_t buffered;                            ///< Number of bytes in buffer
+	lpp_decode_result_t error;                  ///< Error that stopped the decoder
+
+	/**
+	 * @brief Get the size of a field with its channel and type.
+	 * @return LPP_DECODE_OK, or LPP_DECODE_TRUNCATED when the header is not complete, or LPP_DECODE_UNKNOWN_TYPE.
+	 */
+	static lpp_decode_result_t fieldSize(const uint8_t *field, size_t size, size_t *need) {
+		const LppTypeInfo *info = lppFindType(field[1]);
+		size_t used;
+
+		if (!info) {
+			return LPP_DECODE_UNKNOWN_TYPE;
+		}
+		lpp_decode_result_t result = lppValueSize(info, field + 2, size - 2, &used);
+		if (result == LPP_DECODE_OK) {
+			*need = 2 + used;
+		}
+		return result;
+	}
+};
+
+#endif
@@ -0,0 +1,139 @@
+#include "LppTriplets.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define LPP_TRIPLETS_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Decode triplets one value at a time, also used for the triplets after the last full SIMD step.
+ */
+static void unpackScalar(const uint8_t *triplets, size_t count, float divisor, float *x, float *y, float *z) {
+	for (size_t t = 0; t < count; t++, triplets += LPP_TRIPLET_SIZE) {
+		x[t] = (float)(int16_t)((triplets[0] << 8) | triplets[1]) / divisor;
+		y[t] = (float)(int16_t)((triplets[2] << 8) | triplets[3]) / divisor;
+		z[t] = (float)(int16_t)((triplets[4] << 8) | triplets[5]) / divisor;
+	}
+}
+
+#ifdef LPP_TRIPLETS_X86
+
+// Shuffle masks that take one axis of 8 triplets (48 bytes, loaded as a, b and c) and swap the
+// bytes of every value. Byte n of an axis is at 6 * triplet + 2 * axis + n, -1 clears the byte.
+#define LPP_SWAP(i) ((i) ^ 1)
+#define LPP_AXIS_BYTE(axis, part, lane) \
+	((6 * (LPP_SWAP(lane) >> 1) + 2 * (axis) + (LPP_SWAP(lane) & 1)) / 16 == (part) ? \
+	 (6 * (LPP_SWAP(lane) >> 1) + 2 * (axis) + (LPP_SWAP(lane) & 1)) % 16 : -1)
+#define LPP_AXIS_MASK(axis, part) \
+	LPP_AXIS_BYTE(axis, part, 0),  LPP_AXIS_BYTE(axis, part, 1),  LPP_AXIS_BYTE(axis, part, 2),  LPP_AXIS_BYTE(axis, part, 3), \
+	LPP_AXIS_BYTE(axis, part, 4),  LPP_AXIS_BYTE(axis, part, 5),  LPP_AXIS_BYTE(axis, part, 6),  LPP_AXIS_BYTE(axis, part, 7), \
+	LPP_AXIS_BYTE(axis, part, 8),  LPP_AXIS_BYTE(axis, part, 9),  LPP_AXIS_BYTE(axis, part, 10), LPP_AXIS_BYTE(axis, part, 11), \
+	LPP_AXIS_BYTE(axis, part, 12), LPP_AXIS_BYTE(axis, part, 13), LPP_AXIS_BYTE(axis, part, 14), LPP_AXIS_BYTE(axis, part, 15)
+
+static const int8_t axisMasks[3][3][16] = {
+	{{LPP_AXIS_MASK(0, 0)}, {LPP_AXIS_MASK(0, 1)}, {LPP_AXIS_MASK(0, 2)}},
+	{{LPP_AXIS_MASK(1, 0)}, {LPP_AXIS_MASK(1, 1)}, {LPP_AXIS_MASK(1, 2)}},
+	{{LPP_AXIS_MASK(2, 0)}, {LPP_AXIS_MASK(2, 1)}, {LPP_AXIS_MASK(2, 2)}},
+};
+
+__attribute__((target("ssse3")))
+static inline __m128i axisSsse3(__m128i a, __m128i b, __m128i c, int axis) {
+	return _mm_or_si128(_mm_or_si128(
+	           _mm_shuffle_epi8(a, _mm_loadu_si128((const __m128i *)axisMasks[axis][0])),
+	           _mm_shuffle_epi8(b, _mm_loadu_si128((const __m128i *)axisMasks[axis][1]))),
+	           _mm_shuffle_epi8(c, _mm_loadu_si128((const __m128i *)axisMasks[axis][2])));
+}
+
+__attribute__((target("ssse3")))
+static inline void storeSsse3(__m128i values, __m128 divisor, float *out) {
+	// Sign extend the 16-bit values by putting them in the upper half of 32 bits
+	__m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16);
+	__m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(values, values), 16);
+	_mm_storeu_ps(out, _mm_div_ps(_mm_cvtepi32_ps(low), divisor));
+	_mm_storeu_ps(out + 4, _mm_div_ps(_mm_cvtepi32_ps(high), divisor));
+}
+
+__attribute__((target("ssse3")))
+static size_t unpackSsse3(const uint8_t *triplets, size_t count, float divisor, float *x, float *y, float *z) {
+	__m128 divisors = _mm_set1_ps(divisor);
+	size_t t = 0;
+
+	for (; t + 8 <= count; t += 8, triplets += 8 * LPP_TRIPLET_SIZE) {
+		__m128i a = _mm_loadu_si128((const __m128i *)triplets);
+		__m128i b = _mm_loadu_si128((const __m128i *)(triplets + 16));
+		__m128i c = _mm_loadu_si128((const __m128i *)(triplets + 32));
+		storeSsse3(axisSsse3(a, b, c, 0), divisors, x + t);
+		storeSsse3(axisSsse3(a, b, c, 1), divisors, y + t);
+		storeSsse3(axisSsse3(a, b, c, 2), divisors, z + t);
+	}
+	return t;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i axisAvx2(__m256i a, __m256i b, __m256i c, int axis) {
+	return _mm256_or_si256(_mm256_or_si256(
+	           _mm256_shuffle_epi8(a, _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)axisMasks[axis][0]))),
+	           _mm256_shuffle_epi8(b, _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)axisMasks[axis][1])))),
+	           _mm256_shuffle_epi8(c, _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)axisMasks[axis][2]))));
+}
+
+__attribute__((target("avx2")))
+static inline void storeAvx2(__m256i values, __m256 divisor, float *out) {
+	__m256i low = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(values));
+	__m256i high = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(values, 1));
+	_mm256_storeu_ps(out, _mm256_div_ps(_mm256_cvtepi32_ps(low), divisor));
+	_mm256_storeu_ps(out + 8, _mm256_div_ps(_mm256_cvtepi32_ps(high), divisor));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i loadLanes(const uint8_t *low, const uint8_t *high) {
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)low)),
+	                               _mm_loadu_si128((const __m128i *)high), 1);
+}
+
+__attribute__((target("avx2")))
+static size_t unpackAvx2(const uint8_t *triplets, size_t count, float divisor, float *x, float *y, float *z) {
+	__m256 divisors = _mm256_set1_ps(divisor);
+	size_t t = 0;
+
+	// Triplets 0-7 go in the low lanes and 8-15 in the high lanes, the shuffles stay within a lane
+	for (; t + 16 <= count; t += 16, triplets += 16 * LPP_TRIPLET_SIZE) {
+		__m256i a = loadLanes(triplets, triplets + 48);
+		__m256i b = loadLanes(triplets + 16, triplets + 64);
+		__m256i c = loadLanes(triplets + 32, triplets + 80);
+		storeAvx2(axisAvx2(a, b, c, 0), divisors, x + t);
+		storeAvx2(axisAvx2(a, b, c, 1), divisors, y + t);
+		storeAvx2(axisAvx2(a, b, c, 2), divisors, z + t);
+	}
+	return t;
+}
+
+#endif
+
+lpp_simd_t lppSimdLevel(void) {
+#ifdef LPP_TRIPLETS_X86
+	static const lpp_simd_t level = __builtin_cpu_supports("avx2") ? LPP_SIMD_AVX2 :
+	                                __builtin_cpu_supports("ssse3") ? LPP_SIMD_SSSE3 : LPP_SIMD_SCALAR;
+	return level;
+#else
+	return LPP_SIMD_SCALAR;
+#endif
+}
+
+void lppUnpackTriplets(const uint8_t *triplets, size_t count, float divisor, float *x, float *y, float *z,
+                       lpp_simd_t simd) {
+	size_t done = 0;
+
+	if (simd > lppSimdLevel()) {
+		simd = lppSimdLevel();
+	}
+#ifdef LPP_TRIPLETS_X86
+	if (simd == LPP_SIMD_AVX2) {
+		done = unpackAvx2(triplets, count, divisor, x, y, z);
+	}
+	if (simd >= LPP_SIMD_SSSE3) {
+		done += unpackSsse3(triplets + done * LPP_TRIPLET_SIZE, count - done, divisor, x + done, y + done, z + done);
+	}
+#endif
+	unpackScalar(triplets + done * LPP_TRIPLET_SIZE, count - done, divisor, x + done, y + done, z + done);
+}
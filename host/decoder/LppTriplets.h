@@ -0,0 +1,59 @@
+/**
+ * @file  LppTriplets.h
+ * @brief Batch decoding of accelerometer and gyrometer triplets (types 113 and 134) with SIMD.
+ * @note  Uses AVX2 or SSSE3 when the CPU has them, and plain C++ otherwise.
+ * @copyright (c) 2024, Leon Nguyen and Len Verploegen
+ *
+ * The MIT License (MIT), see CustomCayeneLPP.h.
+ *
+ * When fleet history is replayed, most of the work is in the 6-byte triplets: three big-endian
+ * signed 16-bit values. Gather the triplets of many frames into one buffer, for example with
+ * lppFindValue(), and decode them with one call of lppUnpackTriplets().
+ *
+ * @author  Leon Nguyen and Len Verpleogen
+ */
+#ifndef _LPPTRIPLETS_H_
+#define _LPPTRIPLETS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LPP_TRIPLET_SIZE 6  /// \ Size of a triplet, 3 big-endian 16-bit values
+
+/**
+ * @brief Instruction set used by lppUnpackTriplets().
+ */
+enum lpp_simd_t
+{
+	LPP_SIMD_SCALAR = 0,  ///< Plain C++
+	LPP_SIMD_SSSE3,       ///< 8 triplets per step
+	LPP_SIMD_AVX2         ///< 16 triplets per step
+};
+
+/**
+ * @brief Best instruction set of this CPU.
+ */
+lpp_simd_t lppSimdLevel(void);
+
+/**
+ * @brief Decode triplets into separate x, y and z arrays.
+ * Every value is the float nearest to value / divisor, the same on every path.
+ * @param triplets count triplets of LPP_TRIPLET_SIZE bytes, as in the frames.
+ * @param count Number of triplets.
+ * @param divisor Divisor of the values: 1000 for the accelerometer, 100 for the gyrometer.
+ * @param x count x values.
+ * @param y count y values.
+ * @param z count z values.
+ * @param simd Instruction set to use, lower when the CPU does not have it.
+ */
+void lppUnpackTriplets(const uint8_t *triplets, size_t count, float divisor, float *x, float *y, float *z,
+                       lpp_simd_t simd);
+
+/**
+ * @brief Decode triplets with the best instruction set of this CPU.
+ */
+static inline void lppUnpackTriplets(const uint8_t *triplets, size_t count, float divisor, float *x, float *y, float *z) {
+	lppUnpackTriplets(triplets, count, divisor, x, y, z, lppSimdLevel());
+}
+
+#endif
@@ -0,0 +1,412 @@
+/**
+ * @file  lpp_schema.js
+ * @brief Generates the LPP tables of the encoder and the decoders from lpp_schema.json.
+ * @note  Usage: node lpp_schema.js [--check]
+ *        --check only compares the generated code with the files and fails when they differ.
+ * @copyright (c) 2024, Leon Nguyen and Len Verploegen
+ *
+ * The MIT License (MIT), see CustomCayeneLPP.h.
+ *
+ * lpp_schema.json is the only definition of the LPP types, channels, ports and packed schemas.
+ * Packed, delta and deadband frames carry no type information, so the sketch and the decoders
+ * must agree on every size and divisor. The generated files are:
+ *
+ *  - LoRa_TX_RX_Cayenne_HAN/LppTypes.h: type identifiers, sizes and LppType encoder traits,
+ *    also copied to test/Test_CustomCayenneLPP.
+ *  - LoRa_TX_RX_Cayenne_HAN/KissUplinkSchema.h: channels, ports and the packed schemas.
+ *  - The sensor_types and schema tables in LoRa_TX_RX_Cayenne_HAN/payload.javascript.
+ *  - The sensorTypes and packedSchemas tables in host/decoder/LppDecoder.cpp and the fixed layouts
+ *    in LppDecoder.h.
+ *
+ * @author  Leon Nguyen and Len Verpleogen
+ */
+var fs = require('fs');
+var path = require('path');
+
+var ROOT = path.join(__dirname, '../..');
+var SKETCH = path.join(ROOT, 'LoRa_TX_RX_Cayenne_HAN');
+var BEGIN = 'Generated by host/schema/lpp_schema.js from lpp_schema.json, do not edit';
+var END = 'End of generated code';
+
+// Handler kinds, see lpp_dispatch in payload.javascript and lpp_decode_kind_t in LppDecoder.h
+var JS_KINDS = {'values': 'LPP_SCALAR', 'bit': 'LPP_BIT', 'custom': 'LPP_CUSTOM', 'series': 'LPP_SERIES',
+                'axes': 'LPP_AXES', 'gps': 'LPP_GPS', 'colour': 'LPP_COLOUR'};
+var NATIVE_KINDS = {'values': 'LPP_KIND_VALUES', 'bit': 'LPP_KIND_BIT', 'custom': 'LPP_KIND_CUSTOM',
+                    'series': 'LPP_KIND_SERIES', 'axes': 'LPP_KIND_VALUES', 'gps': 'LPP_KIND_VALUES',
+                    'colour': 'LPP_KIND_VALUES'};
+
+var schema = JSON.parse(fs.readFileSync(path.join(__dirname, 'lpp_schema.json'), 'utf8'));
+
+function pad(text, width) {
+    text = String(text);
+    while (text.length < width) {
+        text += ' ';
+    }
+    return text;
+}
+
+function kind(type) {
+    return type.kind || 'values';
+}
+
+function valueCount(type) {
+    return (kind(type) == 'axes' || kind(type) == 'gps' || kind(type) == 'colour') ? 3 : 1;
+}
+
+function divisors(type) {
+    return Array.isArray(type.divisor) ? type.divisor : [type.divisor, type.divisor, type.divisor];
+}
+
+function lookup(list, define, what) {
+    for (var i = 0; i < list.length; i++) {
+        if (list[i].define == define) {
+            return list[i];
+        }
+    }
+    throw 'Unknown ' + what + ' ' + define + ' in lpp_schema.json';
+}
+
+function field(f) {
+    return {'channel': lookup(schema.channels, f.channel, 'channel'), 'type': lookup(schema.types, f.type, 'type'),
+            'bits': f.bits, 'define': f.define, 'doc': f.doc};
+}
+
+// LppType traits exist for types with one resolution for all values, as LppField needs
+function hasTraits(type) {
+    var d = divisors(type);
+    return (kind(type) == 'values' || kind(type) == 'axes' || kind(type) == 'colour') &&
+           d[0] == d[1] && d[1] == d[2] && d[0] <= 0xFFFF;
+}
+
+function cppTypes() {
+    var out = [];
+    out.push('/**');
+    out.push(' * @file  LppTypes.h');
+    out.push(' * @brief LPP data types: identifiers, sizes and encoder traits.');
+    out.push(' * @note  ' + BEGIN + '.');
+    out.push(' *        Change host/schema/lpp_schema.json and run node host/schema/lpp_schema.js.');
+    out.push(' * @copyright (c) 2024, Leon Nguyen and Len Verploegen');
+    out.push(' *');
+    out.push(' * The MIT License (MIT), see CustomCayeneLPP.h.');
+    out.push(' *');
+    out.push(' * @author  Leon Nguyen and Len Verpleogen');
+    out.push(' */');
+    out.push('#ifndef _LPPTYPES_H_');
+    out.push('#define _LPPTYPES_H_');
+    out.push('');
+    out.push('#include <stdint.h>');
+    out.push('');
+    schema.types.forEach(function (type) {
+        out.push(pad('#define ' + type.define + ' ' + type.id, 37) + '/// \\ ' + type.doc);
+    });
+    out.push('');
+    out.push('// The total number of bytes required for the Data ID, Data Type, and Data Size');
+    schema.types.forEach(function (type) {
+        if (kind(type) == 'custom') {
+            return;     // The size is in the header of every value
+        }
+        var line = '#define ' + type.define + '_SIZE ' + (2 + type.size);
+        out.push(kind(type) == 'series' ? pad(line, 37) + '// Without the samples' : line);
+    });
+    out.push('');
+    out.push('/**');
+    out.push(' * @brief Encoding of an LPP data type, for the types with one resolution for all values.');
+    out.push(' * @tparam Type Data type identifier.');
+    out.push(' */');
+    out.push('template <uint8_t Type>');
+    out.push('struct LppType;');
+    schema.types.forEach(function (type) {
+        if (!hasTraits(type)) {
+            return;
+        }
+        out.push('');
+        out.push('template <>');
+        out.push('struct LppType<' + type.define + '> {');
+        out.push('\tstatic const uint16_t resolution = ' + divisors(type)[0] + ';');
+        out.push('\tstatic const uint8_t width = ' + (type.size / valueCount(type)) + ';');
+        out.push('\tstatic const uint8_t values = ' + valueCount(type) + ';');
+        out.push('\tstatic const bool isSigned = ' + type.signed + ';');
+        out.push('};');
+    });
+    out.push('');
+    out.push('#endif');
+    return out.join('\n') + '\n';
+}
+
+function cppSchemas() {
+    var out = [];
+    out.push('/*!');
+    out.push(' * \\file KissUplinkSchema.h');
+    out.push(' * \\brief Channels, ports and layout of the KISS LoRa uplinks.');
+    out.push(' * ' + BEGIN + '.');
+    out.push(' * Change host/schema/lpp_schema.json and run node host/schema/lpp_schema.js, the same file');
+    out.push(' * generates the tables of payload.javascript, so the sketch and the decoder always agree.');
+    out.push(' */');
+    out.push('#ifndef _KISSUPLINKSCHEMA_H_');
+    out.push('#define _KISSUPLINKSCHEMA_H_');
+    out.push('');
+    out.push('#include "CustomCayeneLPP.h"');
+    out.push('');
+    schema.channels.forEach(function (channel) {
+        out.push(pad(pad('#define ' + channel.define, 34) + channel.id, 39) + '///< ' + channel.doc);
+    });
+    out.push('');
+    schema.ports.forEach(function (port) {
+        out.push(pad(pad('#define ' + port.define, 34) + port.id, 39) + '///< ' + port.doc);
+    });
+    schema.schemas.forEach(function (s) {
+        var fields = s.fields.map(field);
+        out.push('');
+        if (fields.some(function (f) { return f.bits; })) {
+            out.push('// ' + s.name + ': ' + s.doc);
+            fields.forEach(function (f) {
+                out.push(pad(pad('#define ' + f.define, 34) + f.bits, 39) + '///< Bits used for the ' + f.doc +
+                         ' in the alarm frame');
+            });
+            return;
+        }
+        out.push('/// ' + s.doc);
+        out.push('typedef LppSchema<');
+        fields.forEach(function (f, n) {
+            out.push('  LppTypeField<' + pad(f.channel.define + ',', 24) + f.type.define + '>' +
+                     (n < fields.length - 1 ? ',' : ''));
+        });
+        out.push('> ' + s.name + ';');
+    });
+    out.push('');
+    out.push('#endif');
+    return out.join('\n') + '\n';
+}
+
+function jsTables() {
+    var out = [];
+    out.push('// sensor_types maps every LPP type byte to its size, name, sign, divisor and handler kind.');
+    out.push('var sensor_types = {');
+    schema.types.forEach(function (type, n) {
+        var divisor = Array.isArray(type.divisor) ? '[' + type.divisor.join(', ') + ']' : type.divisor;
+        out.push('    ' + pad(type.id, 3) + ': {\'size\': ' + type.size + ', \'name\': \'' + type.name + '\', \'signed\': ' +
+                 type.signed + ', \'divisor\': ' + divisor + ', \'kind\': ' + JS_KINDS[kind(type)] + '}' +
+                 (n < schema.types.length - 1 ? ',' : ''));
+    });
+    out.push('};');
+    out.push('');
+    out.push('// Packed frames carry only the values, without channel and type bytes. The layout');
+    out.push('// is agreed in advance and selected by the LoRaWAN port the frame was sent on.');
+    out.push('// Each entry lists the fields in the order the encoder writes them.');
+    out.push('// Fields with \'bits\' are scalars of that many bits, packed most significant bit first.');
+    out.push('var packed_schemas = {');
+    schema.schemas.forEach(function (s, n) {
+        var fields = s.fields.map(field);
+        out.push('    // ' + s.name + ' in KissUplinkSchema.h');
+        out.push('    ' + lookup(schema.ports, s.port, 'port').id + ': [');
+        fields.forEach(function (f, i) {
+            var entry = '{\'channel\': ' + pad(f.channel.id + ',', 4) + '\'type\': ' + f.type.id +
+                        (f.bits ? ', \'bits\': ' + f.bits : '') + '}' + (i < fields.length - 1 ? ',' : '');
+            out.push('        ' + pad(entry, 44) + '// ' + f.doc);
+        });
+        out.push('    ]' + (n < schema.schemas.length - 1 ? ',' : ''));
+    });
+    out.push('};');
+    ['delta', 'deadband'].forEach(function (encoding) {
+        out.push('');
+        if (encoding == 'delta') {
+            out.push('// Delta compressed frames (LppDelta.h) carry the values of a packed schema as zigzag varints.');
+            out.push('// Maps the LoRaWAN port of the delta frames to the port of the packed schema.');
+        } else {
+            out.push('// Report-by-exception frames (LppDeadband.h) carry only the fields of a packed schema that changed.');
+            out.push('// Maps the LoRaWAN port of the deadband frames to the port of the packed schema.');
+        }
+        var entries = schema.schemas.filter(function (s) { return s[encoding]; }).map(function (s) {
+            return '    ' + lookup(schema.ports, s[encoding], 'port').id + ': ' + lookup(schema.ports, s.port, 'port').id;
+        });
+        out.push('var ' + encoding + '_schemas = {');
+        out.push(entries.join(',\n'));
+        out.push('};');
+    });
+    return out.join('\n');
+}
+
+function nativeTable() {
+    var out = [];
+    out.push('// sensor_types in payload.javascript');
+    out.push('static const LppTypeInfo sensorTypes[] = {');
+    schema.types.forEach(function (type) {
+        var d = divisors(type);
+        out.push('\t{' + pad(type.id + ',', 5) + pad(NATIVE_KINDS[kind(type)] + ',', 17) + type.size + ', ' +
+                 pad('"' + type.name + '",', 16) + pad(type.signed + ',', 7) + valueCount(type) + ', {' +
+                 d.join(', ') + '}},');
+    });
+    out.push('};');
+
+    out.push('');
+    out.push('// packed_schemas, delta_schemas and deadband_schemas in payload.javascript');
+    var entries = [];
+    schema.schemas.forEach(function (s) {
+        var fields = s.fields.map(field);
+        var values = 0;
+        out.push('static const LppPackedField packed' + s.name + '[] = {');
+        fields.forEach(function (f) {
+            out.push('\t' + pad('{' + f.channel.id + ', ' + f.type.id + ', ' + (f.bits || 0) + '},', 16) + '// ' + f.doc);
+            values += valueCount(f.type);
+        });
+        out.push('};');
+        if (values > 16) {
+            throw s.name + ' has more values than LPP_DELTA_MAX_VALUES';
+        }
+        var port = function (encoding) {
+            return s[encoding] ? lookup(schema.ports, s[encoding], 'port').id : 0;
+        };
+        entries.push('\t{' + pad(port('port') + ',', 5) + pad(port('delta') + ',', 5) + pad(port('deadband') + ',', 5) +
+                     pad(fields.length + ',', 4) + pad(values + ',', 4) + 'packed' + s.name + '},');
+    });
+    out.push('static const LppPackedSchema packedSchemas[] = {');
+    out.push(entries.join('\n'));
+    out.push('};');
+    return out.join('\n');
+}
+
+// C++ expression of a big-endian value of 1 to 4 bytes at bytes[offset], as lppReadDecimal() reads it
+function cppRead(offset, width, signed) {
+    var b = function (n) {
+        return 'bytes[' + (offset + n) + ']';
+    };
+    switch (width) {
+        case 1:
+            return signed ? '(int8_t)' + b(0) : b(0);
+        case 2:
+            return '(' + (signed ? 'int16_t' : 'uint16_t') + ')((' + b(0) + ' << 8) | ' + b(1) + ')';
+        case 3:
+            var value = '((uint32_t)' + b(0) + ' << 16 | ' + b(1) + ' << 8 | ' + b(2) + ')';
+            return signed ? '(int32_t)((' + value + ' ^ 0x800000) - 0x800000)' : value;
+        default:
+            var word = '((uint32_t)' + b(0) + ' << 24 | (uint32_t)' + b(1) + ' << 16 | ' + b(2) + ' << 8 | ' + b(3) + ')';
+            return signed ? '(int32_t)' + word : word;
+    }
+}
+
+// Fixed layouts of the schemas sent as regular LPP, see LppLayout in LppDecoder.h. A schema has one
+// when the size of every field is known in advance and its channel and type bytes are within the
+// first LPP_LAYOUT_HEADER_SIZE (32) bytes, which must all be part of the frame.
+function nativeLayouts() {
+    var out = [];
+    var layouts = [];
+
+    out.push('// Fixed layouts of the schemas of KissUplinkSchema.h, sent as regular LPP');
+    schema.schemas.forEach(function (s) {
+        var fields = s.fields.map(field);
+        if (fields.some(function (f) { return f.bits || kind(f.type) == 'custom' || kind(f.type) == 'series'; })) {
+            return;
+        }
+        var size = 0;
+        var header = [];
+        fields.forEach(function (f) {
+            header.push(size);
+            size += 2 + f.type.size;
+        });
+        if (size < 32 || header[header.length - 1] + 2 > 32) {
+            return;
+        }
+
+        var mask = [], bytes = [];
+        for (var i = 0; i < 32; i++) {
+            mask.push('0');
+            bytes.push('0');
+        }
+        fields.forEach(function (f, n) {
+            mask[header[n]] = mask[header[n] + 1] = '0xFF';
+            bytes[header[n]] = String(f.channel.id);
+            bytes[header[n] + 1] = String(f.type.id);
+        });
+        out.push('');
+        out.push('/// ' + s.name + ': ' + s.doc);
+        out.push('static const LppLayout lpp' + s.name + 'Layout = {');
+        out.push('\t{' + mask.slice(0, 16).join(', ') + ',');
+        out.push('\t ' + mask.slice(16).join(', ') + '},');
+        out.push('\t{' + bytes.slice(0, 16).join(', ') + ',');
+        out.push('\t ' + bytes.slice(16).join(', ') + '},');
+        out.push('\t' + size);
+        out.push('};');
+        out.push('');
+        out.push('/**');
+        out.push(' * @brief Decode the fields of lpp' + s.name + 'Layout, every value is at a fixed offset.');
+        out.push(' */');
+        out.push('template <typename Visitor>');
+        out.push('static inline void lppExtract' + s.name + '(const uint8_t *bytes, Visitor &visitor) {');
+        out.push('\tdouble values[LPP_DECODER_MAX_VALUES];');
+        fields.forEach(function (f, n) {
+            var count = valueCount(f.type);
+            var width = f.type.size / count;
+            var d = divisors(f.type);
+            out.push('');
+            out.push('\t// ' + f.doc + ', ' + f.channel.define + ' and ' + f.type.define);
+            for (var v = 0; v < count; v++) {
+                var offset = header[n] + 2 + v * width;
+                var value = kind(f.type) == 'bit' ? 'bytes[' + offset + '] & 0x01' : cppRead(offset, width, f.type.signed);
+                out.push('\tvalues[' + v + '] = ' + value + (d[v] == 1 ? '' : ' / ' + d[v] + '.0') + ';');
+            }
+            out.push('\tvisitor.onValue(' + f.channel.id + ', *lppTypes[' + f.type.id + '], values, ' + count + ');');
+        });
+        out.push('}');
+        layouts.push(s.name);
+    });
+
+    out.push('');
+    out.push('/**');
+    out.push(' * @brief Decode the fields of a fixed layout at the start of a frame.');
+    out.push(' * @param bytes The frame.');
+    out.push(' * @param size Size of the frame.');
+    out.push(' * @param visitor Receives the fields of the layout.');
+    out.push(' * @return Size of the layout, or 0 when the frame does not start with a fixed layout.');
+    out.push(' */');
+    out.push('template <typename Visitor>');
+    out.push('static inline size_t lppDecodeLayouts(const uint8_t *bytes, size_t size, Visitor &visitor) {');
+    layouts.forEach(function (name) {
+        var layout = 'lpp' + name + 'Layout';
+        out.push('\tif (size >= ' + layout + '.size && lppMatchLayout(bytes, ' + layout + ')) {');
+        out.push('\t\tlppExtract' + name + '(bytes, visitor);');
+        out.push('\t\treturn ' + layout + '.size;');
+        out.push('\t}');
+    });
+    out.push('\treturn 0;');
+    out.push('}');
+    return out.join('\n');
+}
+
+// Replaces the code between the BEGIN and END comments of a file
+function between(file, comment, code) {
+    var text = fs.readFileSync(file, 'utf8');
+    var begin = text.indexOf(comment + ' ' + BEGIN);
+    var end = text.indexOf(comment + ' ' + END);
+    if (begin < 0 || end < begin) {
+        throw 'No generated code in ' + file;
+    }
+    begin = text.indexOf('\n', begin) + 1;
+    return text.substring(0, begin) + code + '\n' + text.substring(end);
+}
+
+var outputs = {};
+outputs[path.join(SKETCH, 'LppTypes.h')] = cppTypes();
+outputs[path.join(ROOT, 'test/Test_CustomCayenneLPP/LppTypes.h')] = cppTypes();
+outputs[path.join(SKETCH, 'KissUplinkSchema.h')] = cppSchemas();
+outputs[path.join(SKETCH, 'payload.javascript')] = between(path.join(SKETCH, 'payload.javascript'), '//', jsTables());
+outputs[path.join(ROOT, 'host/decoder/LppDecoder.h')] = between(path.join(ROOT, 'host/decoder/LppDecoder.h'), '//',
+                                                               nativeLayouts());
+outputs[path.join(ROOT, 'host/decoder/LppDecoder.cpp')] = between(path.join(ROOT, 'host/decoder/LppDecoder.cpp'), '//',
+                                                                 nativeTable());
+
+var check = process.argv[2] == '--check';
+var stale = 0;
+Object.keys(outputs).forEach(function (file) {
+    var current = fs.existsSync(file) ? fs.readFileSync(file, 'utf8') : null;
+    if (current === outputs[file]) {
+        return;
+    }
+    if (check) {
+        console.error(path.relative(ROOT, file) + ' differs from lpp_schema.json, run node host/schema/lpp_schema.js');
+        stale++;
+    } else {
+        fs.writeFileSync(file, outputs[file]);
+        console.log('Wrote ' + path.relative(ROOT, file));
+    }
+});
+process.exit(stale ? 1 : 0);
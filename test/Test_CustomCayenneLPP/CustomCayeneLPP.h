@@ -28,38 +28,7 @@
 
 #include <Arduino.h>
 
-#define LPP_DIGITAL_INPUT 0         /// \ Identifier for digital input data type (1 Byte)
-#define LPP_DIGITAL_OUTPUT 1        /// \ Identifier for digital output data type (1 Byte)
-#define LPP_ANALOG_INPUT 2          /// \ Identifier for analog input data type (2 bytes and is scaled by a factor of 0.01 (signed)
-#define LPP_ANALOG_OUTPUT 3         /// \ Identifier for analog output data type (2 bytes and is scaled by a factor of 0.01 (signed))
-#define LPP_ADDBIT 4                /// \ Identifier for additional bit data type (1 Byte)
-#define LPP_ADDBYTE 5               /// \ Identifier for additional byte data type (1 Byte)
-#define LPP_ADDWORD 6             	/// \ Identifier for additional 2-byte data type (2 bytes)
-#define LPP_ADDDOUBLEWORD 7         /// \ Identifier for additional 4-byte data type (4 bytes)
-#define LPP_ADDFLOAT 8              /// \ Identifier for additional floating-point data type
-#define LPP_CUSTOMBYTE 9
-#define LPP_LUMINOSITY 101          /// \ Identifier for luminosity data type (2 bytes, 1 lux unsigned)
-#define LPP_PRESENCE 102            /// \ Identifier for presence data type (1 byte, 1)
-#define LPP_TEMPERATURE 103         /// \ Identifier for temperature data type (2 bytes, 0.1°C signed)
-#define LPP_RELATIVE_HUMIDITY 104   /// \ Identifier for relative humidity data type (1 byte, 0.5% unsigned)
-#define LPP_ACCELEROMETER 113       /// \ Identifier for accelerometer data type (2 bytes per axis, 0.001G)
-#define LPP_BAROMETRIC_PRESSURE 115 /// \ Identifier for barometric pressure data type (2 bytes 0.1 hPa Unsigned)
-#define LPP_GYROMETER 134           /// \ Identifier for gyrometer data type (2 bytes per axis, 0.01 °/s)
-#define LPP_GPS 136                 /// \ Identifier for GPS data type (3 byte lon/lat 0.0001 °, 3 bytes alt 0.01 meter)
-
-// The total number of bytes required for the Data ID, Data Type, and Data Size
-#define LPP_DIGITAL_INPUT_SIZE 3       
-#define LPP_DIGITAL_OUTPUT_SIZE 3     
-#define LPP_ANALOG_INPUT_SIZE 4        
-#define LPP_ANALOG_OUTPUT_SIZE 3     
-#define LPP_LUMINOSITY_SIZE 4         
-#define LPP_PRESENCE_SIZE 3         
-#define LPP_TEMPERATURE_SIZE 3        
-#define LPP_RELATIVE_HUMIDITY_SIZE 3   
-#define LPP_ACCELEROMETER_SIZE 8       
-#define LPP_BAROMETRIC_PRESSURE_SIZE 4
-#define LPP_GYROMETER_SIZE 8           
-#define LPP_GPS_SIZE 11              
+#include "LppTypes.h"           // Type identifiers and sizes, generated from host/schema/lpp_schema.json
 
 /**
  * @brief Cayenne Low Power Protocol (LPP) packet builder class.